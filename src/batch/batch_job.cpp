@@ -0,0 +1,90 @@
+#include "batch_job.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "machine/gameboy.h"
+#include "machine/serial/serial_buffer.h"
+
+namespace gb {
+
+bool BatchJob::parse(const std::string &spec) {
+  std::stringstream ss(spec);
+  std::string field;
+  std::getline(ss, rom, ',');
+  while (std::getline(ss, field, ',')) {
+    auto pos = field.find('=');
+    if (pos == std::string::npos) {
+      return false;
+    }
+    auto key   = field.substr(0, pos);
+    auto value = field.substr(pos + 1);
+    if (key == "state") {
+      state = value;
+    } else if (key == "movie") {
+      movie = value;
+    } else if (key == "frames") {
+      frames = std::strtoul(value.c_str(), nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+  return !rom.empty();
+}
+
+BatchResult runBatchJob(const BatchJob &job, u32 default_frames, u32 hash_interval) {
+  BatchResult result;
+  // an unreadable ROM is reported, an unsupported cartridge still aborts the process.
+  auto rom = RomRegistry::instance().open(job.rom);
+  if (!rom) {
+    result.error = "can not open ROM";
+    return result;
+  }
+
+  GameBoy gb(job.rom, {.audio = false, .battery_save = false, .rewind_budget = 0});
+  SerialBuffer serial;
+  gb.serial_.sink(&serial);
+
+  u32 frames = job.frames ? job.frames : default_frames;
+  if (!job.state.empty()) {
+    std::ifstream file(job.state, std::ios::binary);
+    std::vector<u8> state{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (!gb.loadState(state)) {
+      result.error = "invalid save state";
+      return result;
+    }
+  }
+  if (!job.movie.empty()) {
+    Movie movie;
+    if (!movie.load(job.movie)) {
+      result.error = "invalid movie";
+      return result;
+    }
+    frames = job.frames ? job.frames : movie.frames.size();
+    if (!gb.playMovie(std::move(movie))) {
+      result.error = "the movie does not match the ROM";
+      return result;
+    }
+  }
+
+  auto begin       = std::chrono::steady_clock::now();
+  u64 cycles_begin = gb.memory_bus_.cycles();
+  const auto &lcd  = gb.ppu_.lcdData();
+  for (u32 frame = 1; frame <= frames; frame++) {
+    gb.rtc_.step(RTC::CYCLES_PER_FRAME);
+    if (frame % hash_interval == 0 || frame == frames) {
+      result.frame_hashes.push_back(fnv1a(lcd.get(), LCDData::BUFFER_SIZE));
+    }
+  }
+  result.seconds      = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+  result.cycles       = gb.memory_bus_.cycles() - cycles_begin;
+  result.frames       = frames;
+  result.serial       = serial.bytes();
+  result.serial_bytes = serial.total();
+  return result;
+}
+
+} // namespace gb
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// One headless run: a ROM, optionally started from a save state or played from a movie.
+struct BatchJob {
+  std::string rom;
+  std::string state; // save state to start from
+  std::string movie; // .gbm, the run starts from its initial state
+  u32 frames{};      // 0: to the end of the movie, or the default frame count
+
+  // "rom[,state=<file>][,movie=<file>][,frames=<n>]", false if malformed.
+  bool parse(const std::string &spec);
+};
+
+struct BatchResult {
+  std::string error; // empty on success
+  u32 frames{};
+  u64 cycles{};
+  f64 seconds{};
+  std::vector<u64> frame_hashes; // every `hash_interval` frames and the last frame
+  std::vector<u8> serial;        // the last SerialBuffer::CAPACITY bytes sent on the serial port
+  u64 serial_bytes{};            // every byte sent
+};
+
+// frame stepped on the calling thread, no RTC thread and no audio device.
+BatchResult runBatchJob(const BatchJob &job, u32 default_frames, u32 hash_interval);
+
+} // namespace gb
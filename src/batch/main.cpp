@@ -0,0 +1,172 @@
+// gb_batch: run many headless GameBoy instances on every core and report the results as JSON.
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "batch/batch_job.h"
+#include "common/thread_pool.h"
+#include "common/utils.h"
+#include "machine/cpu/rtc.h"
+
+using namespace gb;
+
+static constexpr u32 DEFAULT_FRAMES        = 3600; // one minute of emulated time
+static constexpr u32 DEFAULT_HASH_INTERVAL = 60;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [-j threads] [-f frames] [-i hash_interval] [-l job_file] [-o output.json] [job...]\n"
+          "  job: rom[,state=<file>][,movie=<file>][,frames=<n>], one per line in a job file\n"
+          "  -j  worker threads, default: hardware threads\n"
+          "  -f  frames per job, default: %u, a movie runs to its end\n"
+          "  -i  hash the frame every n frames, default: %u\n"
+          "  -o  results, default: gb_batch.json (the emulator logs to stdout)\n",
+          argv0, DEFAULT_FRAMES, DEFAULT_HASH_INTERVAL);
+}
+
+static void writeString(std::ostream &out, const std::string &str) {
+  out << '"';
+  for (unsigned char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (c < 0x20 || c >= 0x7f) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out << buf;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+static void writeResult(std::ostream &out, const BatchJob &job, const BatchResult &result) {
+  out << "    {\"rom\": ";
+  writeString(out, job.rom);
+  if (!job.state.empty()) {
+    out << ", \"state\": ";
+    writeString(out, job.state);
+  }
+  if (!job.movie.empty()) {
+    out << ", \"movie\": ";
+    writeString(out, job.movie);
+  }
+  if (!result.error.empty()) {
+    out << ", \"error\": ";
+    writeString(out, result.error);
+    out << "}";
+    return;
+  }
+  out << ", \"frames\": " << result.frames << ", \"cycles\": " << result.cycles
+      << ", \"seconds\": " << result.seconds
+      << ", \"cycles_per_second\": " << (u64) perSecond(result.cycles, result.seconds)
+      << ", \"frame_hashes\": [";
+  for (u32 i = 0; i < result.frame_hashes.size(); i++) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "\"%016" PRIx64 "\"", result.frame_hashes[i]);
+    out << (i ? ", " : "") << buf;
+  }
+  out << "], \"serial\": ";
+  writeString(out, {result.serial.begin(), result.serial.end()});
+  out << ", \"serial_bytes\": " << result.serial_bytes << "}";
+}
+
+int main(int argc, char *argv[]) {
+  u32 threads       = std::thread::hardware_concurrency();
+  u32 frames        = DEFAULT_FRAMES;
+  u32 hash_interval = DEFAULT_HASH_INTERVAL;
+  std::string output{"gb_batch.json"};
+  std::vector<std::string> specs;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "j:f:i:l:o:h")) != -1) {
+    switch (opt) {
+      case 'j':
+        threads = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'f':
+        frames = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'i':
+        hash_interval = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+        break;
+      case 'l': {
+        std::ifstream file(optarg);
+        if (!file) {
+          fprintf(stderr, "can not read %s\n", optarg);
+          return 1;
+        }
+        for (std::string line; std::getline(file, line);) {
+          if (!line.empty() && line[0] != '#') {
+            specs.push_back(line);
+          }
+        }
+        break;
+      }
+      case 'o':
+        output = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  for (int i = optind; i < argc; i++) {
+    specs.emplace_back(argv[i]);
+  }
+  if (specs.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<BatchJob> jobs(specs.size());
+  for (u32 i = 0; i < specs.size(); i++) {
+    if (!jobs[i].parse(specs[i])) {
+      fprintf(stderr, "invalid job: %s\n", specs[i].c_str());
+      return 1;
+    }
+  }
+
+  std::vector<BatchResult> results(jobs.size());
+  auto begin = std::chrono::steady_clock::now();
+  {
+    ThreadPool pool(threads);
+    for (u32 i = 0; i < jobs.size(); i++) {
+      pool.submit([&, i] { results[i] = runBatchJob(jobs[i], frames, hash_interval); });
+    }
+    pool.wait();
+    threads = pool.size();
+  }
+  f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+
+  u64 cycles = 0;
+  u32 failed = 0;
+  for (const auto &result : results) {
+    cycles += result.cycles;
+    failed += !result.error.empty();
+  }
+
+  std::ofstream out(output);
+  out << "{\n  \"threads\": " << threads << ",\n  \"seconds\": " << seconds
+      << ",\n  \"cycles_per_second\": " << (u64) perSecond(cycles, seconds) << ",\n  \"jobs\": [\n";
+  for (u32 i = 0; i < jobs.size(); i++) {
+    writeResult(out, jobs[i], results[i]);
+    out << (i + 1 < jobs.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  if (!out) {
+    fprintf(stderr, "can not write %s\n", output.c_str());
+    return 1;
+  }
+
+  fprintf(stderr, "%zu jobs (%u failed) on %u threads in %.2f s, %.1fx real time in total\n", jobs.size(),
+          failed, threads, seconds, perSecond(cycles, seconds) / RTC::FREQUENCY);
+  return failed ? 2 : 0;
+}
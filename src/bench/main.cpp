@@ -0,0 +1,235 @@
+// gb_bench: run a fixed set of ROMs headless and report the emulation speed as JSON,
+// optionally compared against the report of another commit.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "common/profiler.h"
+#include "common/utils.h"
+#include "machine/gameboy.h"
+
+#ifndef GB_GIT_COMMIT
+#define GB_GIT_COMMIT "unknown"
+#endif
+
+using namespace gb;
+
+static constexpr u32 DEFAULT_FRAMES    = 3600; // one minute of emulated time
+static constexpr u32 DEFAULT_RUNS      = 3;
+static constexpr f64 DEFAULT_THRESHOLD = 5;    // percent
+
+// relative to build/, as gb_test. the demos of tools/download_demo.sh are added from ../roms.
+static const char *DEFAULT_ROMS[] = {
+        "../tests/gb-test-roms/cpu_instrs/cpu_instrs.gb",
+        "../tests/gb-test-roms/instr_timing/instr_timing.gb",
+        "../tests/dmg-acid2/dmg-acid2.gb",
+};
+static constexpr const char *DEMO_DIR = "../roms";
+
+// reported with GB_PROFILE, the CPU without the devices it ticks and with its bus accesses.
+static constexpr ProfileZone SUBSYSTEMS[] = {ProfileZone::kCPU, ProfileZone::kPPU, ProfileZone::kAPU,
+                                             ProfileZone::kTIMER, ProfileZone::kSERIAL};
+
+struct BenchResult {
+  std::string rom;
+  u32 frames{};
+  u64 cycles{};
+  u64 instructions{};
+  f64 seconds{};
+  f64 subsystem_seconds[std::size(SUBSYSTEMS)]{};
+};
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [-f frames] [-r runs] [-o output.json] [-b baseline.json] [-t threshold] [rom...]\n"
+          "  rom  default: the test ROMs and the demos in %s, relative to build/\n"
+          "  -f   frames per run, default: %u\n"
+          "  -r   runs per ROM, the fastest is reported, default: %u\n"
+          "  -o   report, default: gb_bench.json\n"
+          "  -b   report of an earlier build to compare with\n"
+          "  -t   slowdown in percent reported as a regression, default: %.0f\n",
+          argv0, DEMO_DIR, DEFAULT_FRAMES, DEFAULT_RUNS, DEFAULT_THRESHOLD);
+}
+
+static BenchResult runBench(const std::string &rom, u32 frames) {
+  BenchResult result;
+  result.rom = rom;
+  GameBoy gb(rom, {.audio = false, .battery_save = false, .rewind_budget = 0});
+
+  Profile::local().reset();
+  u64 cycles_begin       = gb.memory_bus_.cycles();
+  u64 instructions_begin = gb.cpu_.instructions();
+  u64 ticks_begin        = profileTicks();
+  auto begin             = std::chrono::steady_clock::now();
+  for (u32 frame = 0; frame < frames; frame++) {
+    gb.rtc_.step(RTC::CYCLES_PER_FRAME);
+  }
+  result.seconds      = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+  u64 ticks           = profileTicks() - ticks_begin;
+  result.frames       = frames;
+  result.cycles       = gb.memory_bus_.cycles() - cycles_begin;
+  result.instructions = gb.cpu_.instructions() - instructions_begin;
+
+#ifdef GB_PROFILE
+  const auto &profile  = Profile::local();
+  f64 seconds_per_tick = ticks ? result.seconds / ticks : 0;
+  u64 devices          = 0;
+  for (u32 i = 1; i < std::size(SUBSYSTEMS); i++) {
+    u64 device_ticks            = profile.stats(SUBSYSTEMS[i]).ticks;
+    result.subsystem_seconds[i] = device_ticks * seconds_per_tick;
+    devices += device_ticks;
+  }
+  u64 cpu_ticks               = profile.stats(ProfileZone::kCPU).ticks;
+  result.subsystem_seconds[0] = (cpu_ticks > devices ? cpu_ticks - devices : 0) * seconds_per_tick;
+#else
+  (void) ticks;
+#endif
+  return result;
+}
+
+// cycles per second of every ROM in a report written by gb_bench, one ROM per line.
+static bool readBaseline(const std::string &path, std::map<std::string, f64> &baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  static const std::string ROM_KEY = "{\"rom\": \"", SPEED_KEY = "\"cycles_per_second\": ";
+  for (std::string line; std::getline(file, line);) {
+    auto rom   = line.find(ROM_KEY);
+    auto speed = line.find(SPEED_KEY);
+    if (rom == std::string::npos || speed == std::string::npos) {
+      continue;
+    }
+    rom += ROM_KEY.size();
+    auto name      = line.substr(rom, line.find('"', rom) - rom);
+    baseline[name] = std::strtod(&line[speed + SPEED_KEY.size()], nullptr);
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  u32 frames    = DEFAULT_FRAMES;
+  u32 runs      = DEFAULT_RUNS;
+  f64 threshold = DEFAULT_THRESHOLD;
+  std::string output{"gb_bench.json"};
+  std::string baseline_path;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:r:o:b:t:h")) != -1) {
+    switch (opt) {
+      case 'f':
+        frames = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'r':
+        runs = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+        break;
+      case 'o':
+        output = optarg;
+        break;
+      case 'b':
+        baseline_path = optarg;
+        break;
+      case 't':
+        threshold = std::strtod(optarg, nullptr);
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  std::vector<std::string> roms(argv + optind, argv + argc);
+  if (roms.empty()) {
+    for (const char *rom : DEFAULT_ROMS) {
+      roms.emplace_back(rom);
+    }
+    std::vector<std::string> demos;
+    if (std::filesystem::is_directory(DEMO_DIR)) {
+      for (const auto &entry : std::filesystem::directory_iterator(DEMO_DIR)) {
+        if (entry.path().extension() == ".gb") {
+          demos.push_back(entry.path());
+        }
+      }
+    }
+    std::sort(demos.begin(), demos.end());
+    roms.insert(roms.end(), demos.begin(), demos.end());
+  }
+
+  std::map<std::string, f64> baseline;
+  if (!baseline_path.empty() && !readBaseline(baseline_path, baseline)) {
+    fprintf(stderr, "can not read %s\n", baseline_path.c_str());
+    return 1;
+  }
+
+  std::vector<BenchResult> results;
+  for (const auto &rom : roms) {
+    // an unreadable ROM is skipped, an unsupported cartridge still aborts the process.
+    if (!RomRegistry::instance().open(rom)) {
+      fprintf(stderr, "skip %s: can not open\n", rom.c_str());
+      continue;
+    }
+    BenchResult best;
+    for (u32 run = 0; run < runs; run++) {
+      auto result = runBench(rom, frames);
+      if (run == 0 || result.seconds < best.seconds) {
+        best = result;
+      }
+    }
+    results.push_back(best);
+  }
+  if (results.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::ofstream out(output);
+  out << "{\n  \"commit\": \"" << GB_GIT_COMMIT << "\",\n  \"frames\": " << frames
+      << ",\n  \"runs\": " << runs << ",\n  \"roms\": [\n";
+  for (u32 i = 0; i < results.size(); i++) {
+    const auto &r = results[i];
+    // the ROM paths are ours, quotes and backslashes are not expected in them.
+    out << "    {\"rom\": \"" << r.rom << "\""
+        << ", \"cycles_per_second\": " << (u64) perSecond(r.cycles, r.seconds)
+        << ", \"frames_per_second\": " << perSecond(r.frames, r.seconds)
+        << ", \"instructions_per_second\": " << (u64) perSecond(r.instructions, r.seconds)
+        << ", \"seconds\": " << r.seconds;
+#ifdef GB_PROFILE
+    out << ", \"subsystem_seconds\": {";
+    for (u32 zone = 0; zone < std::size(SUBSYSTEMS); zone++) {
+      out << (zone ? ", " : "") << '"' << profileZoneName(SUBSYSTEMS[zone])
+          << "\": " << r.subsystem_seconds[zone];
+    }
+    out << "}";
+#endif
+    out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  if (!out) {
+    fprintf(stderr, "can not write %s\n", output.c_str());
+    return 1;
+  }
+
+  u32 regressions = 0;
+  for (const auto &r : results) {
+    f64 speed = perSecond(r.cycles, r.seconds);
+    fprintf(stderr, "%-50s %7.1fx real time %9.1f frames/s", r.rom.c_str(), speed / RTC::FREQUENCY,
+            perSecond(r.frames, r.seconds));
+    auto it = baseline.find(r.rom);
+    if (it != baseline.end() && it->second > 0) {
+      f64 change = (speed / it->second - 1) * 100;
+      bool slow  = change < -threshold;
+      regressions += slow;
+      fprintf(stderr, " %+6.1f%%%s", change, slow ? " REGRESSION" : "");
+    }
+    fprintf(stderr, "\n");
+  }
+  return regressions ? 2 : 0;
+}
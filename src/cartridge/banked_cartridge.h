@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+
+#include "cartridge.h"
+#include "common/trace.h"
+
+namespace gb {
+
+// Base of the bank switching mappers. The visible ROM and RAM banks are cached as pointers
+// which are only recomputed on bank switches, a read is a single indexed load.
+class BankedCartridge : public Cartridge {
+public:
+  explicit BankedCartridge(std::shared_ptr<const Rom> rom, bool battery_save)
+      : Cartridge(std::move(rom), battery_save) {
+    rom_bank_count_  = std::max<u32>(rom_size_ / ROM_BANK_SIZE, 1);
+    ram_window_mask_ = std::min<u32>(std::max<u32>(ram_size_, 1), RAM_BANK_SIZE) - 1;
+    mapRom0(0);
+    mapRom(1);
+  }
+
+  u16 romBank(u16 addr) const override {
+    return ((addr < ROM_BANK_SIZE ? rom0_ : romx_) - rom_) / ROM_BANK_SIZE;
+  }
+
+protected:
+  static constexpr u32 ROM_BANK_SIZE = 0x4000;
+  static constexpr u32 RAM_BANK_SIZE = 0x2000;
+
+  // 0x0000-0x3fff
+  void mapRom0(u32 bank) {
+    const u8* rom0 = rom_ + (bank % rom_bank_count_) * ROM_BANK_SIZE;
+    if (rom0 != rom0_) {
+      GB_TRACE_INSTANT(kMBC, "rom0 bank", bank % rom_bank_count_);
+    }
+    rom0_ = rom0;
+  }
+
+  // 0x4000-0x7fff
+  void mapRom(u32 bank) {
+    const u8* romx = rom_ + (bank % rom_bank_count_) * ROM_BANK_SIZE;
+    if (romx != romx_) {
+      GB_TRACE_INSTANT(kMBC, "rom bank", bank % rom_bank_count_);
+    }
+    romx_ = romx;
+  }
+
+  // 0xa000-0xbfff, banks past the RAM size wrap around.
+  void mapRam(u32 bank) {
+    u8* ramx = ram_size_ ? ram_ + (bank * RAM_BANK_SIZE) % ram_size_ : nullptr;
+    if (ramx != ramx_) {
+      GB_TRACE_INSTANT(kMBC, "ram bank", bank);
+    }
+    ramx_ = ramx;
+  }
+
+  // RAM disabled (or replaced by registers), reads return 0xff and writes are ignored.
+  void unmapRam() { ramx_ = nullptr; }
+
+  INLINE u8 readRom(u16 addr) const {
+    return addr < ROM_BANK_SIZE ? rom0_[addr] : romx_[addr - ROM_BANK_SIZE];
+  }
+
+  INLINE u8 readRamWindow(u16 addr) const {
+    return ramx_ ? ramx_[(addr - 0xa000) & ram_window_mask_] : 0xff;
+  }
+
+  INLINE void writeRamWindow(u16 addr, u8 val) {
+    if (ramx_) {
+      ramx_[(addr - 0xa000) & ram_window_mask_] = val;
+    }
+  }
+
+  u32 rom_bank_count_{};
+  u32 ram_window_mask_{}; // RAM smaller than a bank (2KiB) is mirrored in the window
+  const u8* rom0_{};
+  const u8* romx_{};
+  u8* ramx_{};
+};
+
+} // namespace gb
@@ -1,38 +1,60 @@
 #pragma once
 
-#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
 
 #include "cartridge_header.h"
+#include "clock_source.h"
 #include "machine/memory/memory_accessor.h"
 #include "nameof.hpp"
+#include "ram_allocator.h"
+#include "rom.h"
+#include "save_file.h"
 
 namespace gb {
 class Cartridge : public MemoryAccessor {
 
 public:
-  explicit Cartridge(const std::string& path) {
-    std::ifstream is(path, std::ios::binary);
-    if (!is.is_open()) {
-      GB_UNREACHABLE();
-    }
-    is.seekg(0, std::ios::end);
-    rom_size_ = is.tellg();
-    is.seekg(0);
-    rom_ = static_cast<u8*>(malloc(rom_size_));
-    if (!rom_) {
-      GB_LOG(ERROR) << "can not alloc memory " << rom_size_ << " to store the cartridge";
-    }
-
-    memset(rom_, 0, rom_size_);
-    is.read((char*) rom_, rom_size_);
-    is.close();
-    header_ = CartridgeHeader(rom_);
+  // `battery_save` persists the RAM of battery backed cartridges next to the ROM (<rom>.sav).
+  Cartridge(std::shared_ptr<const Rom> rom, bool battery_save) : rom_image_(std::move(rom)) {
+    GB_ASSERT(rom_image_);
+    path_     = rom_image_->path();
+    rom_      = rom_image_->data();
+    rom_size_ = rom_image_->size();
+    header_   = CartridgeHeader(rom_);
     GB_LOG(INFO) << "Game: " << header_.title();
     GB_LOG(INFO) << "ROM size: " << rom_size_ << " bytes";
     GB_LOG(INFO) << "Cartridge type: " << NAMEOF_ENUM(header_.type());
+
+    battery_save_ = battery_save && header_.hasBattery();
+    attachRam(header_.ramSizeByKB() * 1024);
   }
 
-  virtual ~Cartridge() { free(rom_); }
+  virtual ~Cartridge() {
+    if (ram_ && !save_file_.data()) {
+      ram_allocator_.deallocate(ram_, ram_size_);
+    }
+  }
+
+  // force the battery backed RAM to disk, `sync` waits for the write back to complete.
+  void flush(bool sync = true) { save_file_.flush(sync); }
+
+  // called with the new motor state when a rumble cartridge turns the motor on or off.
+  using RumbleCallback = std::function<void(bool on)>;
+
+  // time base of the clocks on the cartridge (MBC3 RTC).
+  virtual void clockSource(const ClockSource* clock) {}
+
+  virtual void rumbleCallback(const RumbleCallback& callback) {}
+
+  // the ROM bank mapped at `addr` (0x0000-0x7fff), for the debugger.
+  virtual u16 romBank(u16 addr) const { return addr >= 0x4000; }
+
+  // mapper registers and RAM, the mappers restore their bank pointers when loading.
+  virtual void serialize(StateSerializer& s) { s.bytes(ram_, ram_size_); }
+
+  const std::shared_ptr<const Rom>& romImage() const { return rom_image_; }
 
   const CartridgeHeader& header() const {
     if (rom_) {
@@ -43,32 +65,39 @@ public:
 
 
 protected:
-  enum class WorkMode : u8 { kSIMPLE, kADVANCE };
   CartridgeHeader header_;
 
   std::string path_;
+  std::shared_ptr<const Rom> rom_image_; // shared with the other instances running the same game
   u32 rom_size_{};
-  u8* rom_{};
-  u8 ram_[0x2000 * 128];
-
-  u8 validRamBankMask() const {
-    static constexpr u8 m[] = {0, 0, 0, 0x3, 0xf, 0x7};
-    return m[header_.ramSize()];
+  const u8* rom_{};
+  RamAllocator& ram_allocator_{RamAllocator::global()};
+  u32 ram_size_{};
+  u8* ram_{};
+  bool battery_save_{};
+  SaveFile save_file_;
+
+  // allocate the RAM, or map it from the save file for battery backed cartridges.
+  void attachRam(u32 size) {
+    GB_ASSERT(!ram_);
+    ram_size_ = size;
+    if (!ram_size_) {
+      return;
+    }
+    if (battery_save_) {
+      std::string save_path = std::filesystem::path(path_).replace_extension(".sav").string();
+      if (save_file_.open(save_path, ram_size_)) {
+        ram_ = save_file_.data();
+        GB_LOG(INFO) << "RAM size: " << ram_size_ << " bytes (battery)";
+        return;
+      }
+    }
+    ram_ = ram_allocator_.allocate(ram_size_);
+    if (!ram_) {
+      GB_LOG(ERROR) << "can not alloc memory " << ram_size_ << " to store the cartridge RAM";
+    }
+    GB_LOG(INFO) << "RAM size: " << ram_size_ << " bytes";
   }
-
-  u8 validRomBankMask() const { return (1 << (header_.romSize() + 1)) - 1; }
-
-  union {
-    u8 bank;
-
-    struct {
-      u8 rom_bank : 5 {1};
-      u8 ram_bank : 2 {0};
-      u8 enable_ram : 1 {0};
-    };
-  } bank_;
-
-  WorkMode work_mode_{WorkMode::kSIMPLE};
 };
 
 } // namespace gb
@@ -3,44 +3,45 @@
 #include "cartridge.h"
 #include "cartridge_header.h"
 #include "mbc1.h"
+#include "mbc2.h"
+#include "mbc3.h"
+#include "mbc5.h"
 #include "nameof.hpp"
+#include "rom.h"
+#include "rom_ram.h"
 
 namespace gb {
 
 class CartridgeFactory {
 public:
-  static Cartridge *Create(const std::string &path) {
-    std::ifstream is(path, std::ios::binary);
-    if (!is.is_open()) {
+  // `battery_save` maps the RAM of battery backed cartridges to <rom>.sav, disable it for
+  // throwaway instances which must not touch the player's save.
+  static Cartridge *Create(const std::string &path, bool battery_save = true) {
+    auto rom = RomRegistry::instance().open(path);
+    if (!rom) {
       GB_UNREACHABLE();
     }
-    is.seekg(0, std::ios::end);
-    if (is.tellg() < CartridgeHeader::HEADER_LEN) {
+    return Create(rom, battery_save);
+  }
+
+  static Cartridge *Create(const std::shared_ptr<const Rom> &rom, bool battery_save) {
+    if (rom->size() < CartridgeHeader::HEADER_LEN) {
       GB_LOG(ERROR) << "invalid cartridge file";
     }
-    is.seekg(0);
-    u8 header[CartridgeHeader::HEADER_LEN];
-    is.read((char *) header, CartridgeHeader::HEADER_LEN);
-    is.close();
-    CartridgeHeader cart_header(header);
+    // the header is read straight from the shared mapping.
+    CartridgeHeader cart_header(rom->data());
     switch (cart_header.type()) {
       case CartridgeHeader::kROM_ONLY:
+      case CartridgeHeader::kROM_RAM:
+      case CartridgeHeader::kROM_RAM_BATTERY:
+        return new RomRam(rom, battery_save);
       case CartridgeHeader::kMBC1:
       case CartridgeHeader::kMBC1_RAM:
       case CartridgeHeader::kMBC1_RAM_BATTERY:
-        return new MBC1(path);
+        return new MBC1(rom, battery_save);
       case CartridgeHeader::kMBC2:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC2_BATTERY:
-        goto unsupported;
-        break;
-      case CartridgeHeader::kROM_RAM:
-        goto unsupported;
-        break;
-      case CartridgeHeader::kROM_RAM_BATTERY:
-        goto unsupported;
-        break;
+        return new MBC2(rom, battery_save);
       case CartridgeHeader::kMMM01:
         goto unsupported;
         break;
@@ -51,38 +52,18 @@ public:
         goto unsupported;
         break;
       case CartridgeHeader::kMBC3_TIMER_BATTERY:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC3_TIMER_RAM_BATTERY:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC3:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC3_RAM:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC3_RAM_BATTERY:
-        goto unsupported;
-        break;
+        return new MBC3(rom, battery_save);
       case CartridgeHeader::kMBC5:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC5_RAM:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC5_RAM_BATTERY:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC5_RUMBLE:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC5_RUMBLE_RAM:
-        goto unsupported;
-        break;
       case CartridgeHeader::kMBC5_RUMBLE_RAM_BATTERY:
-        goto unsupported;
-        break;
+        return new MBC5(rom, battery_save);
       case CartridgeHeader::kMBC6:
         goto unsupported;
         break;
@@ -16,7 +16,7 @@ public:
   static constexpr int HEADER_LEN = 0x150;
   CartridgeHeader()               = default;
 
-  CartridgeHeader(u8 *rom) : rom_{rom} {}
+  CartridgeHeader(const u8 *rom) : rom_{rom} {}
 
   enum Type : u8 {
     kROM_ONLY                       = 0x00,
@@ -75,7 +75,7 @@ public:
         break;
       }
     }
-    char *buf = reinterpret_cast<char *>(rom_) + 0x134;
+    const char *buf = reinterpret_cast<const char *>(rom_) + 0x134;
     return {buf, buf + (end_addr - 0x134)};
   }
 
@@ -130,6 +130,12 @@ public:
     }
   }
 
+  bool hasBattery() const {
+    return inOr(type(), kMBC1_RAM_BATTERY, kMBC2_BATTERY, kROM_RAM_BATTERY, kMMM01_RAM_BATTERY,
+                kMBC3_TIMER_BATTERY, kMBC3_TIMER_RAM_BATTERY, kMBC3_RAM_BATTERY, kMBC5_RAM_BATTERY,
+                kMBC5_RUMBLE_RAM_BATTERY, kMBC7_SENSOR_RUMBLE_RAM_BATTERY, kHuC3, kHuC1_RAM_BATTERY);
+  }
+
   u8 ramSize() const {
     // 0x0149
     if (!inAnd(type(), kMBC1_RAM, kMBC1_RAM_BATTERY, kROM_RAM, kROM_RAM_BATTERY, kMMM01_RAM,
@@ -144,8 +150,8 @@ public:
 
   u16 ramSizeByKB() const {
     constexpr u8 map[] = {0, 2, 8, 32, 128, 64};
-    GB_ASSERT(ramSize() >= 0 && ramSize() <= sizeof(map) / sizeof(map[0]));
-    return map[ramSize()];
+    // unknown codes are treated as no RAM
+    return ramSize() < sizeof(map) / sizeof(map[0]) ? map[ramSize()] : 0;
   }
 
   u8 destinationCode() const {
@@ -178,10 +184,10 @@ public:
 
   u16 globalChecksum() const {
     // 0x014E-0x014F
-    return rom_[0x14e] << 8 & rom_[0x14f];
+    return rom_[0x14e] << 8 | rom_[0x14f];
   }
 
-  u8 *rom() const { return rom_; }
+  const u8 *rom() const { return rom_; }
 
 private:
   constexpr inline static u8 nintendo_logo_[] = {
@@ -189,7 +195,7 @@ private:
           0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E, 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
           0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC, 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
   };
-  u8 *rom_{};
+  const u8 *rom_{};
 };
 
 } // namespace gb
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "clock_source.h"
+#include "common/state_serializer.h"
+#include "common/type.h"
+
+namespace gb {
+
+// MBC3 real time clock.
+// The counters are advanced lazily from the elapsed T-cycles of the clock source when
+// they are accessed, nothing runs per cycle. Without a clock source the clock stands still.
+class CartridgeRTC {
+public:
+  enum Register : u8 {
+    kSECONDS = 0,
+    kMINUTES,
+    kHOURS,
+    kDAY_LOW,
+    kDAY_HIGH, // bit 0: day bit 8, bit 6: halt, bit 7: day counter carry
+    kCOUNT,
+  };
+
+  static constexpr u8 DAY_HIGH_DAY   = 0x01;
+  static constexpr u8 DAY_HIGH_HALT  = 0x40;
+  static constexpr u8 DAY_HIGH_CARRY = 0x80;
+
+  void clockSource(const ClockSource *clock) {
+    sync();
+    clock_     = clock;
+    last_sync_ = now();
+  }
+
+  // writing 0x00 then 0x01 copies the counters to the readable registers.
+  void latch(u8 val) {
+    if (latch_armed_ && val == 0x01) {
+      sync();
+      for (u8 i = 0; i < kCOUNT; i++) {
+        latched_[i] = live_[i];
+      }
+    }
+    latch_armed_ = val == 0x00;
+  }
+
+  u8 get(Register reg) const { return latched_[reg]; }
+
+  void set(Register reg, u8 val) {
+    sync();
+    val &= ~UNUSED_BITS[reg];
+    live_[reg] = val;
+    if (reg == kSECONDS) {
+      // writing the seconds resets the sub second prescaler.
+      sub_second_ = 0;
+    }
+  }
+
+  void serialize(StateSerializer &s) { s(last_sync_, sub_second_, latch_armed_, live_, latched_); }
+
+  bool halted() const { return live_[kDAY_HIGH] & DAY_HIGH_HALT; }
+
+  // bring the counters up to the current cycle.
+  void sync() {
+    u64 current = now();
+    u64 elapsed = current - last_sync_;
+    last_sync_  = current;
+    if (halted()) {
+      return;
+    }
+    sub_second_ += elapsed;
+    u64 seconds = sub_second_ / ClockSource::FREQUENCY;
+    sub_second_ %= ClockSource::FREQUENCY;
+    if (seconds) {
+      advance(seconds);
+    }
+  }
+
+private:
+  static constexpr u8 UNUSED_BITS[kCOUNT] = {0xc0, 0xc0, 0xe0, 0x00, 0x3e};
+
+  u64 now() const { return clock_ ? clock_->cycles() : last_sync_; }
+
+  void advance(u64 seconds) {
+    // out of range values written by the game wrap immediately, the hardware counts them up to 63 first.
+    u64 total       = live_[kSECONDS] + seconds;
+    live_[kSECONDS] = total % 60;
+    total           = live_[kMINUTES] + total / 60;
+    live_[kMINUTES] = total % 60;
+    total           = live_[kHOURS] + total / 60;
+    live_[kHOURS]   = total % 24;
+    u64 days        = ((live_[kDAY_HIGH] & DAY_HIGH_DAY) << 8 | live_[kDAY_LOW]) + total / 24;
+    if (days >= 512) {
+      live_[kDAY_HIGH] |= DAY_HIGH_CARRY;
+      days %= 512;
+    }
+    live_[kDAY_LOW]  = days & 0xff;
+    live_[kDAY_HIGH] = (live_[kDAY_HIGH] & ~DAY_HIGH_DAY) | (days >> 8);
+  }
+
+  const ClockSource *clock_{};
+  u64 last_sync_{};
+  u64 sub_second_{};
+  bool latch_armed_{};
+  u8 live_[kCOUNT]{};
+  u8 latched_[kCOUNT]{};
+};
+
+} // namespace gb
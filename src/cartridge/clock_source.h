@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common/type.h"
+
+namespace gb {
+
+// Time base of the clocks on the cartridge, in emulated T-cycles rather than host time
+// so fast forward and headless runs stay deterministic.
+class ClockSource {
+public:
+  static constexpr u32 FREQUENCY = 4'194'304;
+
+  virtual ~ClockSource() = default;
+
+  virtual u64 cycles() const = 0;
+};
+
+} // namespace gb
@@ -1,69 +1,73 @@
 #pragma once
 
-#include "cartridge_header.h"
-#include "machine/memory/memory_accessor.h"
+#include "banked_cartridge.h"
 
 namespace gb {
-class MBC1 : public Cartridge {
+
+// https://gbdev.io/pandocs/MBC1.html
+class MBC1 : public BankedCartridge {
 
 public:
-  explicit MBC1(const std::string& path) : Cartridge(path) {}
+  explicit MBC1(std::shared_ptr<const Rom> rom, bool battery_save)
+      : BankedCartridge(std::move(rom), battery_save) {}
 
   void set(u16 addr, u8 val) override {
-    if (addr <= 0x1fff) {
-      // RAM enable
-      if ((val & 0xf) == 0xa) {
-        bank_.enable_ram = 1;
-      } else {
-        bank_.enable_ram = 0;
-      }
-    } else if (addr >= 0x2000 && addr <= 0x3fff) {
-      // ROM bank
-      val &= 0x1f;
-      if (val == 0) {
-        val = 1;
-      }
-      bank_.rom_bank = val & validRomBankMask();
-    } else if (addr >= 0x4000 && addr <= 0x5fff) {
-      bank_.ram_bank = (val & 0x3);
-    } else if (addr >= 0x6000 && addr <= 0x7fff) {
-      if (val & 1) {
-        work_mode_ = WorkMode::kADVANCE;
-      } else {
-        work_mode_ = WorkMode::kSIMPLE;
-      }
-    } else if (addr >= 0xa000 && addr <= 0xbfff) {
-      if (!bank_.enable_ram) {
+    switch (addr) {
+      case 0x0000 ... 0x1fff:
+        // RAM enable
+        enable_ram_ = (val & 0xf) == 0xa;
+        break;
+      case 0x2000 ... 0x3fff:
+        // ROM bank, the zero check is done on the 5 bits before the bank wraps around the ROM size
+        bank1_ = val & 0x1f;
+        if (bank1_ == 0) {
+          bank1_ = 1;
+        }
+        break;
+      case 0x4000 ... 0x5fff:
+        // RAM bank or upper bits of the ROM bank
+        bank2_ = val & 0x3;
+        break;
+      case 0x6000 ... 0x7fff:
+        work_mode_ = (val & 1) ? WorkMode::kADVANCE : WorkMode::kSIMPLE;
+        break;
+      case 0xa000 ... 0xbfff:
+        writeRamWindow(addr, val);
         return;
-      }
-      if (work_mode_ == WorkMode::kADVANCE) {
-        ram_[(bank_.ram_bank & validRamBankMask()) * 0x2000 + addr - 0xa000] = val;
-      } else {
-        ram_[addr - 0xa000] = val;
-      }
+      default:
+        GB_UNREACHABLE()
     }
+    remap();
   }
 
-  u8 get(u16 addr) const override {
-    if (addr <= 0x3fff) {
-      if (work_mode_ == WorkMode::kADVANCE) {
-        return rom_[((bank_.ram_bank << 5) & validRomBankMask()) * 0x4000 + addr];
-      } else {
-        return rom_[addr];
-      }
-    } else if (addr >= 0x4000 && addr <= 0x7fff) {
-      return rom_[(((bank_.ram_bank << 5) | bank_.rom_bank) & validRomBankMask()) * 0x4000 + addr - 0x4000];
-    } else if (addr >= 0xa000 && addr <= 0xbfff) {
-      if (!bank_.enable_ram) {
-        return 0xff;
-      }
-      if (work_mode_ == WorkMode::kADVANCE) {
-        return ram_[(bank_.ram_bank & validRamBankMask()) * 0x2000 + addr - 0xa000];
-      }
-      return ram_[addr - 0xa000];
+  u8 get(u16 addr) const override { return addr <= 0x7fff ? readRom(addr) : readRamWindow(addr); }
+
+  void serialize(StateSerializer &s) override {
+    Cartridge::serialize(s);
+    s(enable_ram_, bank1_, bank2_, work_mode_);
+    if (s.loading()) {
+      remap();
     }
-    GB_UNREACHABLE()
   }
+
+private:
+  enum class WorkMode : u8 { kSIMPLE, kADVANCE };
+
+  void remap() {
+    bool advance = work_mode_ == WorkMode::kADVANCE;
+    mapRom0(advance ? bank2_ << 5 : 0);
+    mapRom(bank2_ << 5 | bank1_);
+    if (enable_ram_) {
+      mapRam(advance ? bank2_ : 0);
+    } else {
+      unmapRam();
+    }
+  }
+
+  bool enable_ram_{};
+  u8 bank1_{1};
+  u8 bank2_{};
+  WorkMode work_mode_{WorkMode::kSIMPLE};
 };
 
 } // namespace gb
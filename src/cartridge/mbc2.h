@@ -0,0 +1,62 @@
+#pragma once
+
+#include "banked_cartridge.h"
+
+namespace gb {
+
+// https://gbdev.io/pandocs/MBC2.html
+class MBC2 : public BankedCartridge {
+public:
+  explicit MBC2(std::shared_ptr<const Rom> rom, bool battery_save)
+      : BankedCartridge(std::move(rom), battery_save) {
+    // the 512x4 bit RAM is built into the chip, the header reports no RAM.
+    attachRam(RAM_SIZE);
+  }
+
+  void set(u16 addr, u8 val) override {
+    switch (addr) {
+      case 0x0000 ... 0x3fff:
+        // bit 8 of the address selects the register
+        if (addr & 0x100) {
+          rom_bank_ = val & 0xf;
+          mapRom(rom_bank_ ? rom_bank_ : 1);
+        } else {
+          enable_ram_ = (val & 0xf) == 0xa;
+        }
+        break;
+      case 0x4000 ... 0x7fff:
+        break;
+      case 0xa000 ... 0xbfff:
+        if (enable_ram_) {
+          ram_[addr & (RAM_SIZE - 1)] = val & 0xf;
+        }
+        break;
+      default:
+        GB_UNREACHABLE()
+    }
+  }
+
+  u8 get(u16 addr) const override {
+    if (addr <= 0x7fff) {
+      return readRom(addr);
+    }
+    // only the lower nibble is connected, 0xa200-0xbfff mirrors the 512 bytes.
+    return enable_ram_ ? 0xf0 | ram_[addr & (RAM_SIZE - 1)] : 0xff;
+  }
+
+  void serialize(StateSerializer &s) override {
+    Cartridge::serialize(s);
+    s(enable_ram_, rom_bank_);
+    if (s.loading()) {
+      mapRom(rom_bank_ ? rom_bank_ : 1);
+    }
+  }
+
+private:
+  static constexpr u32 RAM_SIZE = 512;
+
+  bool enable_ram_{};
+  u8 rom_bank_{1};
+};
+
+} // namespace gb
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "banked_cartridge.h"
+#include "cartridge_rtc.h"
+
+namespace gb {
+
+// https://gbdev.io/pandocs/MBC3.html
+class MBC3 : public BankedCartridge {
+public:
+  explicit MBC3(std::shared_ptr<const Rom> rom, bool battery_save)
+      : BankedCartridge(std::move(rom), battery_save),
+        has_rtc_(inOr(header_.type(), CartridgeHeader::kMBC3_TIMER_BATTERY,
+                      CartridgeHeader::kMBC3_TIMER_RAM_BATTERY)) {}
+
+  void clockSource(const ClockSource *clock) override { rtc_.clockSource(clock); }
+
+  void set(u16 addr, u8 val) override {
+    switch (addr) {
+      case 0x0000 ... 0x1fff:
+        // RAM and RTC registers enable
+        enable_ = (val & 0xf) == 0xa;
+        remap();
+        break;
+      case 0x2000 ... 0x3fff:
+        // 7 bit ROM bank, 0 selects 1
+        rom_bank_ = val & 0x7f;
+        mapRom(rom_bank_ ? rom_bank_ : 1);
+        break;
+      case 0x4000 ... 0x5fff:
+        // 0x00-0x07 RAM bank, 0x08-0x0c RTC register
+        select_ = val;
+        remap();
+        break;
+      case 0x6000 ... 0x7fff:
+        if (has_rtc_) {
+          rtc_.latch(val);
+        }
+        break;
+      case 0xa000 ... 0xbfff:
+        if (rtcSelected()) {
+          rtc_.set(static_cast<CartridgeRTC::Register>(select_ - RTC_SELECT), val);
+        } else {
+          writeRamWindow(addr, val);
+        }
+        break;
+      default:
+        GB_UNREACHABLE()
+    }
+  }
+
+  u8 get(u16 addr) const override {
+    if (addr <= 0x7fff) {
+      return readRom(addr);
+    }
+    if (rtcSelected()) {
+      return rtc_.get(static_cast<CartridgeRTC::Register>(select_ - RTC_SELECT));
+    }
+    return readRamWindow(addr);
+  }
+
+  void serialize(StateSerializer &s) override {
+    Cartridge::serialize(s);
+    s(enable_, rom_bank_, select_, rtc_);
+    if (s.loading()) {
+      mapRom(rom_bank_ ? rom_bank_ : 1);
+      remap();
+    }
+  }
+
+private:
+  static constexpr u8 RTC_SELECT = 0x08;
+
+  bool rtcSelected() const {
+    return enable_ && has_rtc_ && select_ >= RTC_SELECT && select_ < RTC_SELECT + CartridgeRTC::kCOUNT;
+  }
+
+  void remap() {
+    if (enable_ && select_ < RTC_SELECT) {
+      mapRam(select_);
+    } else {
+      unmapRam();
+    }
+  }
+
+  const bool has_rtc_;
+  bool enable_{};
+  u8 rom_bank_{1};
+  u8 select_{};
+  CartridgeRTC rtc_;
+};
+
+} // namespace gb
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "banked_cartridge.h"
+
+namespace gb {
+
+// https://gbdev.io/pandocs/MBC5.html
+class MBC5 : public BankedCartridge {
+public:
+  explicit MBC5(std::shared_ptr<const Rom> rom, bool battery_save)
+      : BankedCartridge(std::move(rom), battery_save),
+        has_rumble_(inOr(header_.type(), CartridgeHeader::kMBC5_RUMBLE, CartridgeHeader::kMBC5_RUMBLE_RAM,
+                         CartridgeHeader::kMBC5_RUMBLE_RAM_BATTERY)) {}
+
+  void rumbleCallback(const RumbleCallback &callback) override { rumble_callback_ = callback; }
+
+  void set(u16 addr, u8 val) override {
+    switch (addr) {
+      case 0x0000 ... 0x1fff:
+        enable_ram_ = val == 0x0a;
+        remap();
+        break;
+      case 0x2000 ... 0x2fff:
+        // low 8 bits of the 9 bit ROM bank, unlike MBC1 bank 0 is valid
+        rom_bank_ = (rom_bank_ & 0x100) | val;
+        mapRom(rom_bank_);
+        break;
+      case 0x3000 ... 0x3fff:
+        rom_bank_ = (rom_bank_ & 0xff) | (val & 1) << 8;
+        mapRom(rom_bank_);
+        break;
+      case 0x4000 ... 0x5fff:
+        if (has_rumble_) {
+          // bit 3 drives the motor instead of the RAM bank
+          rumble(val & 0x08);
+          val &= 0x07;
+        }
+        ram_bank_ = val & 0x0f;
+        remap();
+        break;
+      case 0x6000 ... 0x7fff:
+        break;
+      case 0xa000 ... 0xbfff:
+        writeRamWindow(addr, val);
+        break;
+      default:
+        GB_UNREACHABLE()
+    }
+  }
+
+  u8 get(u16 addr) const override { return addr <= 0x7fff ? readRom(addr) : readRamWindow(addr); }
+
+  void serialize(StateSerializer &s) override {
+    Cartridge::serialize(s);
+    s(enable_ram_, rumble_, rom_bank_, ram_bank_);
+    if (s.loading()) {
+      mapRom(rom_bank_);
+      remap();
+    }
+  }
+
+private:
+  void remap() {
+    if (enable_ram_) {
+      mapRam(ram_bank_);
+    } else {
+      unmapRam();
+    }
+  }
+
+  void rumble(bool on) {
+    if (on != rumble_ && rumble_callback_) {
+      rumble_callback_(on);
+    }
+    rumble_ = on;
+  }
+
+  const bool has_rumble_;
+  bool enable_ram_{};
+  bool rumble_{};
+  u16 rom_bank_{1};
+  u8 ram_bank_{};
+  RumbleCallback rumble_callback_;
+};
+
+} // namespace gb
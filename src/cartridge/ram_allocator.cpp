@@ -0,0 +1,60 @@
+#include "ram_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace gb {
+
+namespace {
+HeapRamAllocator heap_allocator;
+std::atomic<RamAllocator *> global_allocator{&heap_allocator};
+} // namespace
+
+RamAllocator &RamAllocator::global() { return *global_allocator.load(); }
+
+void RamAllocator::global(RamAllocator *allocator) {
+  global_allocator = allocator ? allocator : &heap_allocator;
+}
+
+u8 *HeapRamAllocator::allocate(u32 size) { return static_cast<u8 *>(calloc(size, 1)); }
+
+void HeapRamAllocator::deallocate(u8 *ram, u32 size) { free(ram); }
+
+PoolRamAllocator::~PoolRamAllocator() {
+  for (auto &[size, blocks] : free_) {
+    for (u8 *block : blocks) {
+      free(block);
+    }
+  }
+}
+
+u8 *PoolRamAllocator::allocate(u32 size) {
+  {
+    std::lock_guard lock(mutex_);
+    auto &blocks = free_[size];
+    if (!blocks.empty()) {
+      u8 *block = blocks.back();
+      blocks.pop_back();
+      memset(block, 0, size);
+      return block;
+    }
+  }
+  return static_cast<u8 *>(calloc(size, 1));
+}
+
+void PoolRamAllocator::deallocate(u8 *ram, u32 size) {
+  std::lock_guard lock(mutex_);
+  free_[size].push_back(ram);
+}
+
+u64 PoolRamAllocator::cached() {
+  std::lock_guard lock(mutex_);
+  u64 bytes = 0;
+  for (auto &[size, blocks] : free_) {
+    bytes += (u64) size * blocks.size();
+  }
+  return bytes;
+}
+
+} // namespace gb
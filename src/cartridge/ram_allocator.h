@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Allocates the external RAM of the cartridges, zero filled.
+// Replace the global allocator before creating GameBoy instances, e.g. with a pool
+// when a host creates and destroys many instances of the same game.
+class RamAllocator {
+public:
+  virtual ~RamAllocator() = default;
+
+  virtual u8 *allocate(u32 size) = 0;
+
+  virtual void deallocate(u8 *ram, u32 size) = 0;
+
+  static RamAllocator &global();
+
+  // nullptr restores the heap allocator, `allocator` must outlive every cartridge it allocated.
+  static void global(RamAllocator *allocator);
+};
+
+class HeapRamAllocator : public RamAllocator {
+public:
+  u8 *allocate(u32 size) override;
+
+  void deallocate(u8 *ram, u32 size) override;
+};
+
+// Keeps the released blocks in per size free lists, the cartridge RAM sizes
+// are few (2, 8, 32, 64 and 128 KiB) so the blocks are reused as is.
+class PoolRamAllocator : public RamAllocator {
+public:
+  ~PoolRamAllocator() override;
+
+  u8 *allocate(u32 size) override;
+
+  void deallocate(u8 *ram, u32 size) override;
+
+  // bytes held in the free lists.
+  u64 cached();
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<u32, std::vector<u8 *>> free_;
+};
+
+} // namespace gb
@@ -0,0 +1,116 @@
+#include "rom.h"
+
+#include <filesystem>
+
+#ifdef __EMSCRIPTEN__
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/logger.h"
+#include "common/utils.h"
+
+namespace gb {
+
+std::shared_ptr<const Rom> Rom::open(const std::string &path) {
+  std::shared_ptr<Rom> rom(new Rom(path));
+  if (!rom->load()) {
+    return nullptr;
+  }
+  return rom;
+}
+
+u64 Rom::hash() const {
+  std::call_once(hash_once_, [this] { hash_ = fnv1a(data_, size_); });
+  return hash_;
+}
+
+#ifndef __EMSCRIPTEN__
+
+bool Rom::load() {
+  int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    GB_LOG(WARN) << "can not open " << path_;
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    GB_LOG(WARN) << "invalid cartridge file " << path_;
+    close(fd);
+    return false;
+  }
+  size_ = st.st_size;
+  // the mapping keeps the file referenced, the descriptor is not needed anymore.
+  void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    GB_LOG(WARN) << "can not map " << path_;
+    return false;
+  }
+  madvise(addr, size_, MADV_WILLNEED);
+  data_   = static_cast<const u8 *>(addr);
+  mapped_ = true;
+  return true;
+}
+
+Rom::~Rom() {
+  if (mapped_) {
+    munmap(const_cast<u8 *>(data_), size_);
+  }
+}
+
+#else
+
+bool Rom::load() {
+  std::ifstream is(path_, std::ios::binary | std::ios::ate);
+  if (!is.is_open() || is.tellg() <= 0) {
+    GB_LOG(WARN) << "invalid cartridge file " << path_;
+    return false;
+  }
+  size_ = is.tellg();
+  buffer_.resize(size_);
+  is.seekg(0);
+  is.read((char *) buffer_.data(), size_);
+  data_ = buffer_.data();
+  return true;
+}
+
+Rom::~Rom() = default;
+
+#endif // __EMSCRIPTEN__
+
+std::shared_ptr<const Rom> RomRegistry::open(const std::string &path) {
+  std::error_code ec;
+  auto key = std::filesystem::weakly_canonical(path, ec).string();
+  if (ec) {
+    key = path;
+  }
+
+  std::lock_guard lock(mutex_);
+  if (auto rom = roms_[key].lock()) {
+    return rom;
+  }
+  auto rom   = Rom::open(path);
+  roms_[key] = rom;
+  return rom;
+}
+
+u32 RomRegistry::size() {
+  std::lock_guard lock(mutex_);
+  u32 count = 0;
+  for (auto it = roms_.begin(); it != roms_.end();) {
+    if (it->second.expired()) {
+      it = roms_.erase(it);
+    } else {
+      count++;
+      it++;
+    }
+  }
+  return count;
+}
+
+} // namespace gb
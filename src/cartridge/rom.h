@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Read-only ROM image. Mapped with mmap where available so every instance
+// running the same game shares one page cache copy, read into memory otherwise (Emscripten).
+class Rom {
+public:
+  // nullptr if the file can not be opened or is empty.
+  static std::shared_ptr<const Rom> open(const std::string &path);
+
+  ~Rom();
+
+  Rom(const Rom &)            = delete;
+  Rom &operator=(const Rom &) = delete;
+
+  const u8 *data() const { return data_; }
+
+  u32 size() const { return size_; }
+
+  const std::string &path() const { return path_; }
+
+  bool mapped() const { return mapped_; }
+
+  // 64-bit FNV-1a of the image, identifies the game in movies and cached results.
+  // computed on the first call.
+  u64 hash() const;
+
+private:
+  explicit Rom(const std::string &path) : path_(path) {}
+
+  bool load();
+
+  std::string path_;
+  const u8 *data_{};
+  u32 size_{};
+  bool mapped_{};
+  std::vector<u8> buffer_; // fallback storage when not mapped
+  mutable std::once_flag hash_once_;
+  mutable u64 hash_{};
+};
+
+// Shares the loaded ROMs between all the GameBoy instances of a process.
+// The registry only holds weak references, a ROM is unmapped when its last cartridge is gone.
+class RomRegistry {
+public:
+  static RomRegistry &instance() {
+    static RomRegistry registry;
+    return registry;
+  }
+
+  std::shared_ptr<const Rom> open(const std::string &path);
+
+  // number of ROMs still alive.
+  u32 size();
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<const Rom>> roms_;
+};
+
+} // namespace gb
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "banked_cartridge.h"
+
+namespace gb {
+
+// 32 KiB ROM without mapper, optionally with up to 8 KiB of RAM.
+class RomRam : public BankedCartridge {
+public:
+  explicit RomRam(std::shared_ptr<const Rom> rom, bool battery_save)
+      : BankedCartridge(std::move(rom), battery_save) { mapRam(0); }
+
+  void set(u16 addr, u8 val) override {
+    if (addr >= 0xa000) {
+      writeRamWindow(addr, val);
+    }
+  }
+
+  u8 get(u16 addr) const override { return addr <= 0x7fff ? readRom(addr) : readRamWindow(addr); }
+};
+
+} // namespace gb
@@ -0,0 +1,103 @@
+#include "save_file.h"
+
+#ifdef __EMSCRIPTEN__
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/logger.h"
+
+namespace gb {
+
+#ifndef __EMSCRIPTEN__
+
+bool SaveFile::open(const std::string &path, u32 size) {
+  close();
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    GB_LOG(WARN) << "can not open save file " << path;
+    return false;
+  }
+  // another instance of the game owns it, sharing the mapping would mix both RAMs.
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+    GB_LOG(WARN) << "save file " << path << " is used by another instance, this one is not saved";
+    ::close(fd);
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || (st.st_size < size && ftruncate(fd, size) != 0)) {
+    GB_LOG(WARN) << "can not resize save file " << path;
+    ::close(fd);
+    return false;
+  }
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    GB_LOG(WARN) << "can not map save file " << path;
+    ::close(fd);
+    return false;
+  }
+  // kept open for the lock.
+  fd_   = fd;
+  path_ = path;
+  data_ = static_cast<u8 *>(addr);
+  size_ = size;
+  GB_LOG(INFO) << "Save file: " << path_;
+  return true;
+}
+
+void SaveFile::close() {
+  if (!data_) {
+    return;
+  }
+  flush();
+  munmap(data_, size_);
+  ::close(fd_);
+  data_ = nullptr;
+  fd_   = -1;
+}
+
+void SaveFile::flush(bool sync) {
+  if (data_) {
+    msync(data_, size_, sync ? MS_SYNC : MS_ASYNC);
+  }
+}
+
+#else
+
+bool SaveFile::open(const std::string &path, u32 size) {
+  close();
+  path_ = path;
+  data_ = new u8[size]{};
+  size_ = size;
+  std::ifstream is(path, std::ios::binary);
+  if (is.is_open()) {
+    is.read((char *) data_, size_);
+  }
+  return true;
+}
+
+void SaveFile::close() {
+  if (!data_) {
+    return;
+  }
+  flush();
+  delete[] data_;
+  data_ = nullptr;
+}
+
+void SaveFile::flush(bool sync) {
+  if (!data_) {
+    return;
+  }
+  std::ofstream os(path_, std::ios::binary);
+  os.write((const char *) data_, size_);
+}
+
+#endif // __EMSCRIPTEN__
+
+} // namespace gb
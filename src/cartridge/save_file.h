@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Battery backed cartridge RAM stored in a .sav file.
+// The file is mapped shared, so the kernel writes the RAM back by itself and flush() only
+// has to force it to disk. The file is locked while open, a second instance of the game gets
+// no save file and keeps its RAM in memory. Without mmap (Emscripten) the RAM is read into
+// memory and flush() writes it back.
+class SaveFile {
+public:
+  SaveFile() = default;
+
+  ~SaveFile() { close(); }
+
+  SaveFile(const SaveFile &)            = delete;
+  SaveFile &operator=(const SaveFile &) = delete;
+
+  // map `size` bytes of `path`, the file is created or grown with zeros as needed. false if
+  // it can not be mapped or another SaveFile holds it.
+  bool open(const std::string &path, u32 size);
+
+  void close();
+
+  // `sync` blocks until the data is on disk, otherwise only schedules the write back.
+  void flush(bool sync = true);
+
+  u8 *data() const { return data_; }
+
+  const std::string &path() const { return path_; }
+
+private:
+  std::string path_;
+  u8 *data_{};
+  u32 size_{};
+  int fd_{-1};
+};
+
+} // namespace gb
@@ -0,0 +1,267 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+namespace {
+
+struct LogRecord {
+  uint64_t time{};  // ns since the epoch, for the JSON output
+  uint64_t order{}; // ns of the steady clock, what the drain sorts on: the wall clock may step back
+  const char *file{};
+  int line{};
+  uint32_t thread{};
+  uint32_t size{}; // bytes of the message following the record in the ring
+  LogLevel level{};
+};
+
+// The records of one thread. the thread pushes and the holder of the drain mutex pops, they never
+// wait for each other.
+class LogRing {
+public:
+  static constexpr size_t SIZE = 64 << 10;
+
+  explicit LogRing(uint32_t thread) : thread_(thread), data_(new char[SIZE]) {}
+
+  uint32_t thread() const { return thread_; }
+
+  // false if the record does not fit for now.
+  bool push(const LogRecord &record, const char *message) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    if (SIZE - (head - tail) < sizeof(record) + record.size) {
+      return false;
+    }
+    copyIn(head, &record, sizeof(record));
+    copyIn(head + sizeof(record), message, record.size);
+    head_.store(head + sizeof(record) + record.size, std::memory_order_release);
+    return true;
+  }
+
+  bool halfFull() const {
+    return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed) > SIZE / 2;
+  }
+
+  template<typename F>
+  void drain(F &&f) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    while (tail < head) {
+      LogRecord record;
+      copyOut(tail, &record, sizeof(record));
+      std::string message(record.size, '\0');
+      copyOut(tail + sizeof(record), message.data(), record.size);
+      tail += sizeof(record) + record.size;
+      f(record, std::move(message));
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+private:
+  void copyIn(uint64_t pos, const void *src, size_t size) {
+    size_t offset = pos % SIZE;
+    size_t first  = std::min(size, SIZE - offset);
+    memcpy(&data_[offset], src, first);
+    memcpy(&data_[0], (const char *) src + first, size - first);
+  }
+
+  void copyOut(uint64_t pos, void *dst, size_t size) const {
+    size_t offset = pos % SIZE;
+    size_t first  = std::min(size, SIZE - offset);
+    memcpy(dst, &data_[offset], first);
+    memcpy((char *) dst + first, &data_[0], size - first);
+  }
+
+  const uint32_t thread_;
+  std::unique_ptr<char[]> data_;
+  std::atomic<uint64_t> head_{};
+  std::atomic<uint64_t> tail_{};
+};
+
+} // namespace
+
+class LogBackend::Impl {
+public:
+  static constexpr auto FLUSH_PERIOD = std::chrono::milliseconds(20);
+
+  Impl() {
+    const char *format = std::getenv("GB_LOG_FORMAT");
+    if (format && std::string_view(format) == "json") {
+      format_ = LogFormat::kJSON;
+    }
+#ifndef __EMSCRIPTEN__
+    // the emscripten thread pool has a single thread, taken by the emulation, it writes synchronously.
+    std::thread([this] { run(); }).detach();
+#endif
+  }
+
+  void write(LogLevel log_level, const char *file, int line, const std::string &message) {
+    auto &ring = this->ring();
+    LogRecord record{now<std::chrono::system_clock>(),
+                     now<std::chrono::steady_clock>(),
+                     file,
+                     line,
+                     ring.thread(),
+                     (uint32_t) message.size(),
+                     log_level};
+#ifndef __EMSCRIPTEN__
+    if (log_level < LogLevel::kERROR && sizeof(record) + message.size() <= LogRing::SIZE) [[likely]] {
+      while (!ring.push(record, message.data())) {
+        // full, drain it ourselves rather than lose the message.
+        std::lock_guard lock(drain_mutex_);
+        drainLocked();
+      }
+      if (ring.halfFull()) {
+        wake_.notify_one();
+      }
+      return;
+    }
+#endif
+    // the earlier messages first, an ERROR is the last thing the process writes.
+    std::lock_guard lock(drain_mutex_);
+    drainLocked();
+    output(record, message);
+    std::cout.flush();
+    std::cerr.flush();
+  }
+
+  void flush() {
+    std::lock_guard lock(drain_mutex_);
+    drainLocked();
+  }
+
+  std::atomic<LogFormat> format_{LogFormat::kTEXT};
+
+private:
+  template<typename Clock>
+  static uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+  }
+
+  LogRing &ring() {
+    thread_local std::shared_ptr<LogRing> ring = [this] {
+      std::lock_guard lock(rings_mutex_);
+      rings_.push_back(std::make_shared<LogRing>(++threads_));
+      return rings_.back();
+    }();
+    return *ring;
+  }
+
+  void run() {
+    std::unique_lock lock(wake_mutex_);
+    while (true) {
+      wake_.wait_for(lock, FLUSH_PERIOD);
+      flush();
+    }
+  }
+
+  // the queued messages of every thread in time order.
+  void drainLocked() {
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+      std::lock_guard lock(rings_mutex_);
+      rings = rings_;
+      // the ring of a finished thread is only referenced here, it goes after this last drain.
+      rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                  [](const auto &ring) { return ring.use_count() == 2; }),
+                   rings_.end());
+    }
+    batch_.clear();
+    for (auto &ring : rings) {
+      ring->drain([&](const LogRecord &record, std::string message) {
+        batch_.emplace_back(record, std::move(message));
+      });
+    }
+    if (batch_.empty()) {
+      return;
+    }
+    std::stable_sort(batch_.begin(), batch_.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.first.order < rhs.first.order; });
+    for (const auto &[record, message] : batch_) {
+      output(record, message);
+    }
+    std::cout.flush();
+    std::cerr.flush();
+  }
+
+  void output(const LogRecord &record, const std::string &message) {
+    auto &out = record.level < LogLevel::kWARN ? std::cout : std::cerr;
+    if (format_.load(std::memory_order_relaxed) == LogFormat::kTEXT) {
+      out << LogMessage::withColor(record.level, true) << "[" << getNameFromLogLevel(record.level) << "] ("
+          << record.file << ":" << record.line << ") " << message << LogMessage::withColor(record.level, false)
+          << '\n';
+      return;
+    }
+    line_.clear();
+    line_ += "{\"time\": " + std::to_string(record.time) + ", \"level\": \"" +
+             getNameFromLogLevel(record.level) + "\", \"file\": ";
+    appendJson(record.file);
+    line_ += ", \"line\": " + std::to_string(record.line) + ", \"thread\": " + std::to_string(record.thread) +
+             ", \"message\": ";
+    appendJson(message);
+    line_ += "}\n";
+    out << line_;
+  }
+
+  void appendJson(std::string_view text) {
+    line_ += '"';
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        line_ += '\\';
+        line_ += c;
+      } else if ((unsigned char) c < 0x20) {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char) c);
+        line_ += escaped;
+      } else {
+        line_ += c;
+      }
+    }
+    line_ += '"';
+  }
+
+  std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<LogRing>> rings_;
+  uint32_t threads_{};
+
+  std::mutex drain_mutex_; // held to pop the rings and write
+  std::vector<std::pair<LogRecord, std::string>> batch_;
+  std::string line_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+};
+
+LogBackend::LogBackend() : impl_(new Impl) {}
+
+LogBackend &LogBackend::instance() {
+  // never destroyed, the writer thread and the threads logging at exit may still use it.
+  static LogBackend *backend = [] {
+    auto *backend = new LogBackend;
+    std::atexit([] { LogBackend::instance().flush(); });
+    return backend;
+  }();
+  return *backend;
+}
+
+void LogBackend::write(LogLevel log_level, const char *file, int line, const std::string &message) {
+  impl_->write(log_level, file, line, message);
+}
+
+void LogBackend::flush() { impl_->flush(); }
+
+void LogBackend::format(LogFormat format) { impl_->format_.store(format, std::memory_order_relaxed); }
+
+} // namespace utils
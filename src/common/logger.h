@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <string>
 
 namespace utils {
 
@@ -34,6 +35,36 @@ static inline constexpr const char *getNameFromLogLevel(LogLevel log_level) {
   }
 }
 
+enum class LogFormat {
+  kTEXT, // "[INFO] (file:line) message", colored
+  kJSON, // one object per line: time (ns since the epoch), level, file, line, thread, message
+};
+
+// Asynchronous sink of GB_LOG. a message is formatted by the logging thread and queued on its own
+// lock-free ring, a writer thread drains the rings in time order to stdout (TRACE to INFO) and
+// stderr (WARN and ERROR). ERROR drains and writes synchronously before the process is killed.
+// a thread finding its ring full drains the rings itself. GB_LOG_FORMAT=json selects LogFormat::kJSON.
+class LogBackend {
+public:
+  static LogBackend &instance();
+
+  void write(LogLevel log_level, const char *file, int line, const std::string &message);
+
+  // return once every message queued so far is written, e.g. before redirecting std::cout.
+  void flush();
+
+  void format(LogFormat format);
+
+private:
+  class Impl;
+
+  LogBackend();
+
+  Impl *impl_;
+};
+
+inline void flushLog() { LogBackend::instance().flush(); }
+
 // This class is used in this case:
 // GLOBAL_LOG_LEVEL = TRACE;
 // GB_LOG(ERROR) << "COMPILE ERROR";
@@ -47,16 +78,12 @@ public:
   LogMessage(LogLevel log_level, const char *file, int line)
       : log_level_(log_level),
         file_(file),
-        line_(line) {
-    stream_ << withColor(true);
-    stream_ << "[" << getNameFromLogLevel(log_level) << "] ";
-    stream_ << "(" << file_ << ":" << line_ << ") ";
-  }
+        line_(line) {}
 
-  inline constexpr const char *withColor(bool is_prefix) const {
+  static inline constexpr const char *withColor(LogLevel log_level, bool is_prefix) {
 #ifndef _WIN32
     if (!is_prefix) return "\x1b[0m";
-    switch (log_level_) {
+    switch (log_level) {
       case LogLevel::kTRACE:
         return "\x1b[90m";
       case LogLevel::kDEBUG:
@@ -75,16 +102,9 @@ public:
   }
 
   ~LogMessage() {
-    stream_ << withColor(false) << std::endl;
-    if (log_level_ < LogLevel::kWARN) [[likely]] {
-      std::cout << stream_.str();
-      std::cout.flush();
-    } else {
-      std::cerr << stream_.str();
-      std::cerr.flush();
-      if (log_level_ == LogLevel::kERROR) [[unlikely]] {
-        killProcess();
-      }
+    LogBackend::instance().write(log_level_, file_, line_, stream_.str());
+    if (log_level_ == LogLevel::kERROR) [[unlikely]] {
+      killProcess();
     }
   }
 
@@ -99,15 +119,20 @@ private:
 
 } // namespace utils
 
-//constexpr static utils::LogLevel GLOBAL_LOG_LEVEL = utils::LogLevel::kTRACE;
-constexpr static utils::LogLevel GLOBAL_LOG_LEVEL = utils::LogLevel::kINFO;
+// the lowest level compiled in (cmake -DGB_LOG_LEVEL=WARN), the arguments of the messages below it
+// are never evaluated. ERROR is always compiled in.
+#ifndef GB_LOG_MIN_LEVEL
+#define GB_LOG_MIN_LEVEL kINFO
+#endif
+constexpr static utils::LogLevel GLOBAL_LOG_LEVEL = utils::LogLevel::GB_LOG_MIN_LEVEL;
 
 #define GB_LOG_STREAM(log_level) ::utils::LogMessage(log_level, __FILE__, __LINE__).stream()
 
-#define GB_LOG_IS_ENABLE(log_level) GLOBAL_LOG_LEVEL > (log_level)
+#define GB_LOG_IS_ENABLE(log_level) \
+  ((log_level) >= GLOBAL_LOG_LEVEL || (log_level) >= ::utils::LogLevel::kERROR)
 
 #define GB_LAZY_LOG(log_level, stream) \
-  GB_LOG_IS_ENABLE(log_level) ? (void) 0 : ::utils::LogMessageVoidify() & (stream)
+  !GB_LOG_IS_ENABLE(log_level) ? (void) 0 : ::utils::LogMessageVoidify() & (stream)
 
 #define GB_LOG_LEVEL(raw_log_level) ::utils::LogLevel::k##raw_log_level
 
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "common/type.h"
+#include "common/utils.h"
+
+namespace gb {
+
+// Aho-Corasick automaton over a few byte strings, fed a byte at a time. finds them in a stream in
+// constant time per byte and without keeping the stream.
+class PatternMatcher {
+public:
+  static constexpr u32 NONE = UINT32_MAX;
+
+  explicit PatternMatcher(const std::vector<std::string> &patterns) {
+    addState();
+    for (u32 i = 0; i < patterns.size(); i++) {
+      GB_ASSERT(!patterns[i].empty());
+      u32 state = 0;
+      for (u8 byte : patterns[i]) {
+        if (next_[state][byte] == NONE) {
+          u32 added          = addState();
+          next_[state][byte] = added;
+        }
+        state = next_[state][byte];
+      }
+      match_[state] = std::min(match_[state], i);
+    }
+
+    // breadth first, the failure state of a state is shallower and already complete.
+    std::vector<u32> fail(next_.size()), queue;
+    for (auto &to : next_[0]) {
+      if (to == NONE) {
+        to = 0;
+      } else {
+        queue.push_back(to);
+      }
+    }
+    for (u32 i = 0; i < queue.size(); i++) {
+      u32 state     = queue[i];
+      match_[state] = std::min(match_[state], match_[fail[state]]);
+      for (u32 byte = 0; byte < 256; byte++) {
+        u32 &to = next_[state][byte];
+        if (to == NONE) {
+          to = next_[fail[state]][byte];
+        } else {
+          fail[to] = next_[fail[state]][byte];
+          queue.push_back(to);
+        }
+      }
+    }
+  }
+
+  // the index of the pattern ending with `byte`, the lowest if several do, or NONE.
+  u32 feed(u8 byte) {
+    state_ = next_[state_][byte];
+    return match_[state_];
+  }
+
+  void reset() { state_ = 0; }
+
+private:
+  u32 addState() {
+    next_.emplace_back();
+    next_.back().fill(NONE);
+    match_.push_back(NONE);
+    return next_.size() - 1;
+  }
+
+  std::vector<std::array<u32, 256>> next_;
+  std::vector<u32> match_;
+  u32 state_{};
+};
+
+} // namespace gb
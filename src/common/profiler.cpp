@@ -0,0 +1,129 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace gb {
+
+static std::mutex &registryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::vector<Profile *> &registry() {
+  static std::vector<Profile *> profiles;
+  return profiles;
+}
+
+const char *profileZoneName(ProfileZone zone) {
+  static constexpr const char *NAMES[] = {
+          "cpu",
+          "ppu",
+          "apu",
+          "timer",
+          "serial",
+          "ppu hblank",
+          "ppu vblank",
+          "ppu oam scan",
+          "ppu drawing",
+          "bus rom",
+          "bus vram",
+          "bus external ram",
+          "bus wram",
+          "bus oam",
+          "bus unusable",
+          "bus io",
+          "bus hram",
+  };
+  static_assert(std::size(NAMES) == Profile::ZONES);
+  return NAMES[static_cast<u8>(zone)];
+}
+
+Profile::Profile() {
+  static u32 next_thread = 0;
+  std::lock_guard lock(registryMutex());
+  thread_ = ++next_thread;
+  registry().push_back(this);
+}
+
+Profile::~Profile() {
+  std::lock_guard lock(registryMutex());
+  auto &profiles = registry();
+  profiles.erase(std::remove(profiles.begin(), profiles.end(), this), profiles.end());
+}
+
+Profile::Stats Profile::stats(ProfileZone zone) const {
+  const auto &counter = counters_[static_cast<u8>(zone)];
+  return {counter.calls.load(std::memory_order_relaxed), counter.ticks.load(std::memory_order_relaxed),
+          counter.self_ticks.load(std::memory_order_relaxed)};
+}
+
+void Profile::reset() {
+  for (auto &counter : counters_) {
+    counter.calls.store(0, std::memory_order_relaxed);
+    counter.ticks.store(0, std::memory_order_relaxed);
+    counter.self_ticks.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::vector<Profile::Snapshot> Profile::collect() {
+  std::lock_guard lock(registryMutex());
+  std::vector<Snapshot> snapshots;
+  for (const auto *profile : registry()) {
+    auto &snapshot  = snapshots.emplace_back();
+    snapshot.thread = profile->thread_;
+    for (u8 zone = 0; zone < ZONES; zone++) {
+      snapshot.zones[zone] = profile->stats(static_cast<ProfileZone>(zone));
+    }
+  }
+  std::sort(snapshots.begin(), snapshots.end(),
+            [](const Snapshot &lhs, const Snapshot &rhs) { return lhs.thread < rhs.thread; });
+  return snapshots;
+}
+
+void Profile::resetAll() {
+  std::lock_guard lock(registryMutex());
+  for (auto *profile : registry()) {
+    profile->reset();
+  }
+}
+
+f64 Profile::ticksPerSecond() {
+  static const f64 rate = [] {
+    auto begin     = std::chrono::steady_clock::now();
+    u64 tick_begin = profileTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    u64 ticks   = profileTicks() - tick_begin;
+    f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+    return ticks / seconds;
+  }();
+  return rate;
+}
+
+std::string Profile::report() {
+  f64 ms_per_tick = 1000 / ticksPerSecond();
+  std::string out;
+  char line[128];
+  for (const auto &snapshot : collect()) {
+    snprintf(line, sizeof(line), "thread %u\n%-18s %14s %12s %12s %10s\n", snapshot.thread, "zone", "calls",
+             "total ms", "self ms", "ns/call");
+    out += line;
+    for (u8 zone = 0; zone < ZONES; zone++) {
+      const auto &stats = snapshot.zones[zone];
+      if (stats.calls == 0) {
+        continue;
+      }
+      snprintf(line, sizeof(line), "%-18s %14llu %12.1f %12.1f %10.1f\n",
+               profileZoneName(static_cast<ProfileZone>(zone)), (unsigned long long) stats.calls,
+               stats.ticks * ms_per_tick, stats.self_ticks * ms_per_tick,
+               stats.ticks * ms_per_tick * 1e6 / stats.calls);
+      out += line;
+    }
+  }
+  return out;
+}
+
+} // namespace gb
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "common/type.h"
+#include "common/utils.h"
+
+namespace gb {
+
+// Calls and host time per emulator subsystem, compiled in with GB_PROFILE (cmake -DGB_PROFILE=ON),
+// the scope macros are empty otherwise. zones nest: the CPU ticks the devices and the bus, so
+// `ticks` includes the zones entered below and `self_ticks` does not.
+enum class ProfileZone : u8 {
+  kCPU,
+  kPPU,
+  kAPU,
+  kTIMER,
+  kSERIAL,
+  // PPU::tick by the mode it starts in, in the order of PPURegister::PPUMode.
+  kPPU_HORIZONTAL_BLANK,
+  kPPU_VERTICAL_BLANK,
+  kPPU_OAM_SCAN,
+  kPPU_DRAWING_PIXELS,
+  // MemoryBus::get and set by the region of getMemory.
+  kBUS_ROM,
+  kBUS_VRAM,
+  kBUS_EXTERNAL_RAM,
+  kBUS_WRAM,
+  kBUS_OAM,
+  kBUS_UNUSABLE,
+  kBUS_IO,
+  kBUS_HRAM,
+  kCOUNT,
+};
+
+const char *profileZoneName(ProfileZone zone);
+
+// the time stamp counter where there is one, see Profile::ticksPerSecond.
+INLINE u64 profileTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+#endif
+}
+
+class ProfileScope;
+
+// The counters of one thread. only the owner writes them, with plain relaxed stores rather than
+// atomic increments, so any thread can read them while they run.
+class Profile {
+public:
+  static constexpr u8 ZONES = static_cast<u8>(ProfileZone::kCOUNT);
+
+  struct Stats {
+    u64 calls{};
+    u64 ticks{};
+    u64 self_ticks{};
+  };
+
+  struct Snapshot {
+    u32 thread{}; // numbered in the order the threads first counted
+    Stats zones[ZONES];
+  };
+
+  static Profile &local() {
+    static thread_local Profile profile;
+    return profile;
+  }
+
+  Profile(const Profile &)            = delete;
+  Profile &operator=(const Profile &) = delete;
+
+  Stats stats(ProfileZone zone) const;
+
+  void reset();
+
+  // every thread which has counted something and is still alive.
+  static std::vector<Snapshot> collect();
+
+  // an update racing with it may survive.
+  static void resetAll();
+
+  // measured once against the steady clock.
+  static f64 ticksPerSecond();
+
+  // a table per thread of the zones entered since the last reset.
+  static std::string report();
+
+private:
+  friend class ProfileScope;
+
+  struct Counter {
+    std::atomic<u64> calls{};
+    std::atomic<u64> ticks{};
+    std::atomic<u64> self_ticks{};
+  };
+
+  Profile();
+
+  ~Profile();
+
+  INLINE static void add(std::atomic<u64> &counter, u64 val) {
+    counter.store(counter.load(std::memory_order_relaxed) + val, std::memory_order_relaxed);
+  }
+
+  u32 thread_{};
+  Counter counters_[ZONES];
+  ProfileScope *top_{}; // innermost open scope
+};
+
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileZone zone)
+      : profile_(Profile::local()),
+        zone_(zone),
+        parent_(profile_.top_),
+        begin_(profileTicks()) {
+    profile_.top_ = this;
+  }
+
+  ~ProfileScope() {
+    u64 ticks     = profileTicks() - begin_;
+    auto &counter = profile_.counters_[static_cast<u8>(zone_)];
+    Profile::add(counter.calls, 1);
+    Profile::add(counter.ticks, ticks);
+    Profile::add(counter.self_ticks, ticks - child_ticks_);
+    profile_.top_ = parent_;
+    if (parent_) {
+      parent_->child_ticks_ += ticks;
+    }
+  }
+
+  ProfileScope(const ProfileScope &)            = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  Profile &profile_;
+  ProfileZone zone_;
+  ProfileScope *parent_;
+  u64 begin_;
+  u64 child_ticks_{};
+};
+
+#define GB_PROFILE_CONCAT_(a, b) a##b
+#define GB_PROFILE_CONCAT(a, b) GB_PROFILE_CONCAT_(a, b)
+
+#ifdef GB_PROFILE
+// `zone` is an expression of ProfileZone.
+#define GB_PROFILE_ZONE_SCOPE(zone) ::gb::ProfileScope GB_PROFILE_CONCAT(gb_profile_scope_, __LINE__)(zone)
+#else
+#define GB_PROFILE_ZONE_SCOPE(zone)
+#endif
+
+// `zone` is the name of a ProfileZone value, e.g. GB_PROFILE_SCOPE(kCPU).
+#define GB_PROFILE_SCOPE(zone) GB_PROFILE_ZONE_SCOPE(::gb::ProfileZone::zone)
+
+} // namespace gb
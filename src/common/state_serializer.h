@@ -0,0 +1,140 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Reads or writes the machine state as a little endian byte stream.
+// Components describe their state once with `void serialize(StateSerializer &s)`,
+// listing the fields in a fixed order; the same function saves and loads.
+class StateSerializer {
+public:
+  enum class Mode : u8 {
+    kSAVE,
+    kLOAD,
+    kMEASURE, // only count the bytes
+  };
+
+  static StateSerializer save(std::span<u8> out) { return {Mode::kSAVE, out.data(), (u32) out.size()}; }
+
+  static StateSerializer load(std::span<const u8> in) {
+    return {Mode::kLOAD, const_cast<u8 *>(in.data()), (u32) in.size()};
+  }
+
+  static StateSerializer measure() { return {Mode::kMEASURE, nullptr, 0}; }
+
+  bool loading() const { return mode_ == Mode::kLOAD; }
+
+  // false once the buffer was too small (or too short when loading), the rest is skipped.
+  bool ok() const { return ok_; }
+
+  u32 offset() const { return offset_; }
+
+  // bytes left in the buffer, to check a length read from the stream before trusting it.
+  u32 remaining() const { return offset_ < size_ ? size_ - offset_ : 0; }
+
+  // invalid data, skip the rest.
+  void fail() { ok_ = false; }
+
+  template<typename T>
+    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  void operator()(T &val) {
+    if constexpr (std::is_enum_v<T>) {
+      auto raw = static_cast<std::underlying_type_t<T>>(val);
+      (*this)(raw);
+      val = static_cast<T>(raw);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      u8 raw = val;
+      (*this)(raw);
+      val = raw;
+    } else if constexpr (std::is_floating_point_v<T>) {
+      using U = std::conditional_t<sizeof(T) == 4, u32, u64>;
+      auto raw = std::bit_cast<U>(val);
+      (*this)(raw);
+      val = std::bit_cast<T>(raw);
+    } else {
+      using U = std::make_unsigned_t<T>;
+      u8 *p   = reserve(sizeof(T));
+      if (!p) {
+        return;
+      }
+      if (mode_ == Mode::kSAVE) {
+        for (u32 i = 0; i < sizeof(T); i++) {
+          p[i] = static_cast<U>(val) >> (i * 8);
+        }
+      } else if (mode_ == Mode::kLOAD) {
+        U raw{};
+        for (u32 i = 0; i < sizeof(T); i++) {
+          raw |= static_cast<U>(p[i]) << (i * 8);
+        }
+        val = static_cast<T>(raw);
+      }
+    }
+  }
+
+  template<typename T>
+    requires requires(T &t, StateSerializer &s) { t.serialize(s); }
+  void operator()(T &val) {
+    val.serialize(*this);
+  }
+
+  template<typename T, size_t N>
+  void operator()(T (&arr)[N]) {
+    if constexpr (sizeof(T) == 1 && std::is_arithmetic_v<T>) {
+      bytes(reinterpret_cast<u8 *>(arr), N);
+    } else {
+      for (auto &val : arr) {
+        (*this)(val);
+      }
+    }
+  }
+
+  template<typename... T>
+  void operator()(T &...vals)
+    requires(sizeof...(T) > 1)
+  {
+    ((*this)(vals), ...);
+  }
+
+  void bytes(u8 *data, u32 size) {
+    u8 *p = reserve(size);
+    if (!p || !size) {
+      return;
+    }
+    if (mode_ == Mode::kSAVE) {
+      memcpy(p, data, size);
+    } else if (mode_ == Mode::kLOAD) {
+      memcpy(data, p, size);
+    }
+  }
+
+private:
+  StateSerializer(Mode mode, u8 *data, u32 size) : mode_(mode), data_(data), size_(size) {}
+
+  u8 *reserve(u32 size) {
+    u32 offset = offset_;
+    offset_ += size;
+    if (mode_ == Mode::kMEASURE) {
+      return nullptr;
+    }
+    if (!ok_ || offset_ > size_) {
+      ok_ = false;
+      return nullptr;
+    }
+    return data_ + offset;
+  }
+
+  Mode mode_;
+  u8 *data_{};
+  u32 size_{};
+  u32 offset_{};
+  bool ok_{true};
+};
+
+} // namespace gb
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Fixed set of workers, each with its own queue. A worker runs its own tasks newest first
+// and steals the oldest task of another worker when it runs out, so long and short jobs
+// even out without a single contended queue.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(u32 threads = std::thread::hardware_concurrency()) {
+    threads = std::max(threads, 1u);
+    for (u32 i = 0; i < threads; i++) {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (u32 i = 0; i < threads; i++) {
+      threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+  }
+
+  // run what is queued, then join.
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &)            = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  u32 size() const { return threads_.size(); }
+
+  void submit(Task task) {
+    pending_++;
+    u32 index = next_queue_++ % queues_.size();
+    {
+      // counted before the queue is unlocked, a thief decrements it only once it holds the task.
+      std::lock_guard lock(queues_[index]->mutex);
+      queues_[index]->tasks.push_back(std::move(task));
+      std::lock_guard count_lock(mutex_);
+      queued_++;
+    }
+    wake_cv_.notify_one();
+  }
+
+  // block until every submitted task has finished.
+  void wait() {
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [&] { return pending_ == 0; });
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool pop(u32 self, Task &task) {
+    for (u32 i = 0; i < queues_.size(); i++) {
+      auto &queue = *queues_[(self + i) % queues_.size()];
+      std::lock_guard lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      std::lock_guard count_lock(mutex_);
+      queued_--;
+      return true;
+    }
+    return false;
+  }
+
+  void work(u32 self) {
+    Task task;
+    while (true) {
+      if (pop(self, task)) {
+        task();
+        task = nullptr;
+        if (--pending_ == 0) {
+          std::lock_guard lock(mutex_);
+          done_cv_.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock lock(mutex_);
+      wake_cv_.wait(lock, [&] { return stop_ || queued_ > 0; });
+      if (stop_ && queued_ == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<u32> next_queue_{};
+  std::atomic<u32> pending_{}; // submitted and not finished
+
+  std::mutex mutex_;
+  u32 queued_{}; // submitted and not started, guarded by `mutex_`
+  bool stop_{};
+  std::condition_variable wake_cv_;
+  std::condition_variable done_cv_;
+};
+
+} // namespace gb
@@ -0,0 +1,182 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "common/logger.h"
+
+namespace gb {
+
+static std::mutex &registryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::vector<Trace *> &registry() {
+  static std::vector<Trace *> traces;
+  return traces;
+}
+
+const char *traceTrackName(TraceTrack track) {
+  static constexpr const char *NAMES[] = {
+          "host", "frame", "ppu mode", "irq raised", "irq serviced", "dma", "mbc",
+  };
+  static_assert(std::size(NAMES) == static_cast<u8>(TraceTrack::kCOUNT));
+  return NAMES[static_cast<u8>(track)];
+}
+
+// the key of TraceEvent::arg in the exported events.
+static const char *traceArgName(TraceTrack track) {
+  static constexpr const char *NAMES[] = {
+          "arg", "frame", "ly", "type", "return address", "source", "bank",
+  };
+  static_assert(std::size(NAMES) == static_cast<u8>(TraceTrack::kCOUNT));
+  return NAMES[static_cast<u8>(track)];
+}
+
+Trace::Trace() {
+  static u32 next_thread = 0;
+  std::lock_guard lock(registryMutex());
+  thread_ = ++next_thread;
+  registry().push_back(this);
+}
+
+Trace::~Trace() {
+  std::lock_guard lock(registryMutex());
+  auto &traces = registry();
+  traces.erase(std::remove(traces.begin(), traces.end(), this), traces.end());
+}
+
+void Trace::clearAll() {
+  std::lock_guard lock(registryMutex());
+  for (auto *trace : registry()) {
+    std::lock_guard trace_lock(trace->mutex_);
+    trace->next_ = 0;
+  }
+}
+
+static constexpr const char *END_FORMAT = "{\"ph\": \"E\", \"ts\": %.3f, \"pid\": %u, \"tid\": %u},\n";
+
+std::string Trace::chromeJson() {
+  struct Thread {
+    u32 id{};
+    const char *name{};
+  };
+  struct Event {
+    TraceEvent event;
+    u32 thread{};
+  };
+
+  std::vector<Thread> threads;
+  std::vector<Event> events;
+  {
+    std::lock_guard lock(registryMutex());
+    for (auto *trace : registry()) {
+      std::lock_guard trace_lock(trace->mutex_);
+      if (trace->next_ == 0) {
+        continue;
+      }
+      threads.push_back({trace->thread_, trace->name_});
+      u64 first = trace->next_ > RING_SIZE ? trace->next_ - RING_SIZE : 0;
+      for (u64 i = first; i < trace->next_; i++) {
+        events.push_back({trace->ring_[i % RING_SIZE], trace->thread_});
+      }
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event &lhs, const Event &rhs) { return lhs.event.ticks < rhs.event.ticks; });
+
+  // pid 1 is the host, a thread per recording thread. every machine is a process with a thread
+  // per guest track.
+  std::map<const ClockSource *, u32> machines;
+  for (const auto &e : events) {
+    if (e.event.track != TraceTrack::kHOST && !machines.count(e.event.machine)) {
+      u32 pid = machines.size() + 2;
+      machines.emplace(e.event.machine, pid);
+    }
+  }
+
+  std::string out = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+  char line[256];
+  auto metadata = [&](const char *kind, u32 pid, u32 tid, const std::string &name) {
+    snprintf(line, sizeof(line),
+             "{\"name\": \"%s\", \"ph\": \"M\", \"pid\": %u, \"tid\": %u, "
+             "\"args\": {\"name\": \"%s\"}},\n",
+             kind, pid, tid, name.c_str());
+    out += line;
+  };
+  metadata("process_name", 1, 0, "host");
+  for (const auto &thread : threads) {
+    metadata("thread_name", 1, thread.id, thread.name ? thread.name : "thread " + std::to_string(thread.id));
+  }
+  u32 number = 0;
+  for (const auto &[machine, pid] : machines) {
+    // guest events recorded outside of a GB_TRACE_CLOCK scope, e.g. while a cartridge is created.
+    metadata("process_name", pid, 0, machine ? "gameboy " + std::to_string(++number) : "no clock");
+    for (u8 track = 1; track < static_cast<u8>(TraceTrack::kCOUNT); track++) {
+      metadata("thread_name", pid, track, traceTrackName(static_cast<TraceTrack>(track)));
+    }
+  }
+
+  f64 us_per_tick = 1e6 / Profile::ticksPerSecond();
+  u64 begin       = events.empty() ? 0 : events.front().event.ticks;
+  // open spans per (pid, tid), an end without its begin was cut by the ring.
+  std::map<u64, u32> depth;
+  for (const auto &e : events) {
+    const auto &event = e.event;
+    bool host         = event.track == TraceTrack::kHOST;
+    u32 pid           = host ? 1 : machines[event.machine];
+    u32 tid           = host ? e.thread : static_cast<u8>(event.track);
+    u32 &open         = depth[(u64) pid << 32 | tid];
+    f64 ts            = (event.ticks - begin) * us_per_tick;
+    if (event.phase == 'E') {
+      if (open == 0) {
+        continue;
+      }
+      open--;
+      snprintf(line, sizeof(line), END_FORMAT, ts, pid, tid);
+    } else {
+      open += event.phase == 'B';
+      snprintf(line, sizeof(line),
+               "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\",%s \"ts\": %.3f, \"pid\": %u, "
+               "\"tid\": %u",
+               event.name, traceTrackName(event.track), event.phase,
+               event.phase == 'i' ? " \"s\": \"t\"," : "", ts, pid, tid);
+      out += line;
+      if (host) {
+        out += "},\n";
+        continue;
+      }
+      snprintf(line, sizeof(line), ", \"args\": {\"cycle\": %llu, \"%s\": %u}},\n",
+               (unsigned long long) event.cycle, traceArgName(event.track), event.arg);
+    }
+    out += line;
+  }
+
+  f64 end = events.empty() ? 0 : (events.back().event.ticks - begin) * us_per_tick;
+  for (const auto &[key, open] : depth) {
+    for (u32 i = 0; i < open; i++) {
+      snprintf(line, sizeof(line), END_FORMAT, end, (u32) (key >> 32), (u32) key);
+      out += line;
+    }
+  }
+  // JSON has no trailing comma, the metadata always precedes.
+  out.erase(out.size() - 2);
+  out += "\n]}\n";
+  return out;
+}
+
+bool Trace::writeChromeJson(const std::string &path) {
+  std::ofstream file(path);
+  file << chromeJson();
+  if (!file) {
+    GB_LOG(WARN) << "can not write " << path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace gb
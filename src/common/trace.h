@@ -0,0 +1,145 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cartridge/clock_source.h"
+#include "common/profiler.h"
+#include "common/type.h"
+#include "common/utils.h"
+
+namespace gb {
+
+// Timeline of the emulation for chrome://tracing and ui.perfetto.dev, compiled in with GB_TRACE
+// (cmake -DGB_TRACE=ON), the macros are empty otherwise. every thread records into its own ring of
+// its last Trace::RING_SIZE events, stamped with the host clock so the guest events line up with
+// the host spans. guest events also carry the emulated cycle of the machine of the thread, see
+// GB_TRACE_CLOCK.
+enum class TraceTrack : u8 {
+  kHOST, // spans of the recording thread
+  kFRAME,
+  kPPU_MODE,
+  kIRQ_RAISED,
+  kIRQ_SERVICED,
+  kDMA,
+  kMBC,
+  kCOUNT,
+};
+
+const char *traceTrackName(TraceTrack track);
+
+struct TraceEvent {
+  const char *name{}; // a string literal
+  const ClockSource *machine{};
+  u64 ticks{}; // profileTicks()
+  u64 cycle{};
+  u32 arg{};
+  char phase{}; // 'B' begin, 'E' end of the innermost span of the track, 'i' instant
+  TraceTrack track{};
+};
+
+class Trace {
+public:
+  static constexpr u32 RING_SIZE = 1 << 17; // about 2 s of a single machine
+
+  static Trace &local() {
+    static thread_local Trace trace;
+    return trace;
+  }
+
+  Trace(const Trace &)            = delete;
+  Trace &operator=(const Trace &) = delete;
+
+  // shown as the name of the thread, a string literal.
+  void threadName(const char *name) { name_ = name; }
+
+  // the machine running on this thread, see TraceClockScope.
+  const ClockSource *clock() const { return clock_; }
+
+  void clock(const ClockSource *clock) { clock_ = clock; }
+
+  void record(TraceTrack track, char phase, const char *name, u32 arg = 0) {
+    TraceEvent event{name, clock_, profileTicks(), clock_ ? clock_->cycles() : 0, arg, phase, track};
+    std::lock_guard lock(mutex_);
+    if (ring_.empty()) [[unlikely]] {
+      ring_.resize(RING_SIZE);
+    }
+    ring_[next_++ % RING_SIZE] = event;
+  }
+
+  // the rings of every live thread as Chrome trace JSON. the spans cut by the ring wrapping are
+  // dropped, the ones still open are closed at the last event.
+  static std::string chromeJson();
+
+  static bool writeChromeJson(const std::string &path);
+
+  static void clearAll();
+
+private:
+  Trace();
+
+  ~Trace();
+
+  std::mutex mutex_; // the owner records, an export reads
+  std::vector<TraceEvent> ring_;
+  u64 next_{};
+  u32 thread_{};
+  const char *name_{};
+  const ClockSource *clock_{};
+};
+
+// a host span of the calling thread.
+class TraceScope {
+public:
+  explicit TraceScope(const char *name) : trace_(Trace::local()) {
+    trace_.record(TraceTrack::kHOST, 'B', name);
+  }
+
+  ~TraceScope() { trace_.record(TraceTrack::kHOST, 'E', nullptr); }
+
+  TraceScope(const TraceScope &)            = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  Trace &trace_;
+};
+
+// stamp the guest events of this thread with the cycles of `clock` until the end of the scope.
+class TraceClockScope {
+public:
+  explicit TraceClockScope(const ClockSource *clock) : trace_(Trace::local()), previous_(trace_.clock()) {
+    trace_.clock(clock);
+  }
+
+  ~TraceClockScope() { trace_.clock(previous_); }
+
+  TraceClockScope(const TraceClockScope &)            = delete;
+  TraceClockScope &operator=(const TraceClockScope &) = delete;
+
+private:
+  Trace &trace_;
+  const ClockSource *previous_;
+};
+
+#ifdef GB_TRACE
+// `name` is a string literal, `track` the name of a TraceTrack value and `arg` a number shown with
+// the event, e.g. GB_TRACE_INSTANT(kMBC, "rom bank", bank).
+#define GB_TRACE_SCOPE(name) ::gb::TraceScope GB_PROFILE_CONCAT(gb_trace_scope_, __LINE__)(name)
+#define GB_TRACE_RECORD(track, phase, name, arg) \
+  ::gb::Trace::local().record(::gb::TraceTrack::track, phase, name, arg)
+#define GB_TRACE_BEGIN(track, name, arg) GB_TRACE_RECORD(track, 'B', name, arg)
+#define GB_TRACE_END(track) GB_TRACE_RECORD(track, 'E', nullptr, 0)
+#define GB_TRACE_INSTANT(track, name, arg) GB_TRACE_RECORD(track, 'i', name, arg)
+#define GB_TRACE_CLOCK(clock) ::gb::TraceClockScope GB_PROFILE_CONCAT(gb_trace_clock_, __LINE__)(clock)
+#define GB_TRACE_THREAD(name) ::gb::Trace::local().threadName(name)
+#else
+#define GB_TRACE_SCOPE(name)
+#define GB_TRACE_BEGIN(track, name, arg)
+#define GB_TRACE_END(track)
+#define GB_TRACE_INSTANT(track, name, arg)
+#define GB_TRACE_CLOCK(clock)
+#define GB_TRACE_THREAD(name)
+#endif
+
+} // namespace gb
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 
 template<typename R, typename... U>
 static inline bool inAnd(R cond, U... args) {
@@ -27,6 +29,17 @@ inline static T setBitN(T val, int n) {
   return clearBitN(val, n) | (1 << n);
 }
 
+// 64-bit FNV-1a, identifies ROM images and frames. chain calls with `hash`.
+inline static uint64_t fnv1a(const uint8_t *data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ data[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// a rate for the reports, 0 if nothing was measured.
+inline static double perSecond(double value, double seconds) { return seconds > 0 ? value / seconds : 0; }
+
 #ifdef NDEBUG
 #define GB_ASSERT(IGNORE)
 #else
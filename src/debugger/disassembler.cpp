@@ -23,7 +23,7 @@ void Disassembler::disassembleROM() {
 }
 
 u8 Disassembler::disassemble(u16 pc, bool force_update) {
-  if (!enable_ && !force_update) {
+  if (!force_update && !enable_.load(std::memory_order_acquire)) {
     return 0;
   }
 
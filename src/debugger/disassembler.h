@@ -1,6 +1,7 @@
 #pragma once
 
-#include <array>
+#include <atomic>
+#include <vector>
 
 #include "common/type.h"
 #include "common/utils.h"
@@ -23,15 +24,32 @@ struct DisassembleRecord {
 
 class Disassembler {
 public:
-  void enable() { enable_ = true; }
+  // the records (1 MiB) are allocated and the ROM decoded on the first enable,
+  // headless instances never pay for them. the decoding reads the mapped ROM banks, call it on
+  // the emulation thread (GameBoy::post) or while it is paused.
+  void enable() {
+    if (!ready_.load(std::memory_order_relaxed)) {
+      records_.resize(0x10000);
+      disassembleROM();
+      ready_.store(true, std::memory_order_release);
+    }
+    enable_.store(true, std::memory_order_release);
+  }
+
+  void disable() { enable_.store(false, std::memory_order_relaxed); }
+
+  bool enabled() const { return enable_.load(std::memory_order_relaxed); }
 
-  void disable() { enable_ = false; }
+  // the records may be read from another thread, once the first enable() is done.
+  bool ready() const { return ready_.load(std::memory_order_acquire); }
 
+  // before the machine runs.
   void memoryBus(MemoryBus* memory_bus) {
+    enable_.store(false, std::memory_order_relaxed);
+    ready_.store(false, std::memory_order_relaxed);
     memory_bus_ = memory_bus;
-    std::fill(records_.begin(), records_.end(), DisassembleRecord{});
+    records_.clear();
     records_count_ = 0;
-    disassembleROM();
   }
 
   void disassembleROM();
@@ -42,18 +60,19 @@ public:
 
   u16 recordCount() const { return records_count_; }
 
-  static bool isReturn(u8 op) { return inOr(op, 0xC7, 0xCF, 0xD7, 0xDF, 0xE7, 0xEF, 0xF7, 0xFF); }
+  static bool isRst(u8 op) { return inOr(op, 0xC7, 0xCF, 0xD7, 0xDF, 0xE7, 0xEF, 0xF7, 0xFF); }
 
   static bool isJump(u8 op) {
     return inOr(op, 0xC3, 0xE9, 0x18, 0xC2, 0xCA, 0xD2, 0xDA, 0x20, 0x28, 0x30, 0x38);
   }
 
-  static bool isBasicBlockEnd(u8 op) { return isJump(op) || isReturn(op); }
+  static bool isBasicBlockEnd(u8 op) { return isJump(op) || isRst(op); }
 
 private:
-  bool enable_{};
+  std::atomic<bool> enable_{};
+  std::atomic<bool> ready_{};
   const MemoryBus* memory_bus_{};
-  std::array<DisassembleRecord, 0x10000> records_;
+  std::vector<DisassembleRecord> records_;
   u16 records_count_{};
 
 
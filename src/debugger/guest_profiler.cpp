@@ -0,0 +1,233 @@
+#include "guest_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "common/logger.h"
+#include "disassembler.h"
+
+namespace gb {
+
+static bool isCall(u8 op) { return inOr(op, 0xCD, 0xC4, 0xCC, 0xD4, 0xDC) || Disassembler::isRst(op); }
+
+static bool isRet(u8 op) { return inOr(op, 0xC9, 0xC0, 0xC8, 0xD0, 0xD8, 0xD9); }
+
+void GuestProfiler::reset() {
+  std::fill(std::begin(opcodes_), std::end(opcodes_), 0);
+  hotspots_.clear();
+  nodes_.assign(1, Node{});
+  children_.clear();
+  frames_.clear();
+}
+
+void GuestProfiler::instruction(Location from, Location to, u16 opcode, u16 sp_before, u16 sp_after,
+                                u8 cycles) {
+  opcodes_[opcode]++;
+  auto& hotspot    = hotspots_[from];
+  hotspot.location = from;
+  hotspot.count++;
+  hotspot.cycles += cycles;
+  // the CALL belongs to the caller and the RET to the callee.
+  nodes_[current()].self_cycles += cycles;
+
+  if (opcode > 0xff) {
+    return;
+  }
+  if (isCall(opcode) && sp_after == (u16) (sp_before - 2)) {
+    call(to, false, sp_before);
+  } else if (isRet(opcode) && sp_after == (u16) (sp_before + 2)) {
+    ret(sp_after);
+  }
+}
+
+void GuestProfiler::interrupt(Location handler, u16 sp, u8 cycles) {
+  call(handler, true, sp + 2);
+  nodes_[current()].self_cycles += cycles;
+}
+
+void GuestProfiler::halted(u8 cycles) {
+  u32 node = child(current(), HALT, false);
+  nodes_[node].self_cycles += cycles;
+}
+
+u32 GuestProfiler::child(u32 parent, Location function, bool interrupt) {
+  u64 key = (u64) parent << 32 | function | (interrupt ? 1u << 30 : 0);
+  auto it = children_.find(key);
+  if (it != children_.end()) {
+    return it->second;
+  }
+  u32 node = nodes_.size();
+  nodes_.push_back({.parent = parent, .function = function, .interrupt = interrupt});
+  children_.emplace(key, node);
+  return node;
+}
+
+void GuestProfiler::call(Location function, bool interrupt, u16 return_sp) {
+  if (frames_.size() == MAX_DEPTH) {
+    return;
+  }
+  u32 node = child(current(), function, interrupt);
+  nodes_[node].calls++;
+  frames_.push_back({node, return_sp});
+}
+
+void GuestProfiler::ret(u16 sp) {
+  // the frames whose return address is at or below SP are gone, which also unwinds the frames left
+  // by code popping its return address instead of returning.
+  while (!frames_.empty() && frames_.back().return_sp <= sp) {
+    frames_.pop_back();
+  }
+}
+
+std::vector<GuestProfiler::Hotspot> GuestProfiler::hotspots(u32 n) const {
+  std::vector<Hotspot> result;
+  result.reserve(hotspots_.size());
+  for (const auto& [location, hotspot] : hotspots_) {
+    result.push_back(hotspot);
+  }
+  auto by_cycles = [](const Hotspot& lhs, const Hotspot& rhs) {
+    return lhs.cycles != rhs.cycles ? lhs.cycles > rhs.cycles : lhs.location < rhs.location;
+  };
+  n = std::min<u32>(n, result.size());
+  std::partial_sort(result.begin(), result.begin() + n, result.end(), by_cycles);
+  result.resize(n);
+  return result;
+}
+
+std::vector<GuestProfiler::Function> GuestProfiler::functions() const {
+  // children come after their parent, one backward pass sums the subtrees.
+  std::vector<u64> total(nodes_.size());
+  for (u32 node = nodes_.size(); node-- > 0;) {
+    total[node] += nodes_[node].self_cycles;
+    if (node != 0) {
+      total[nodes_[node].parent] += total[node];
+    }
+  }
+
+  std::unordered_map<u64, Function> functions;
+  for (u32 node = 1; node < nodes_.size(); node++) {
+    const auto& n = nodes_[node];
+    if (n.function == HALT) {
+      continue;
+    }
+    auto& function = functions[(u64) n.function << 1 | n.interrupt];
+    function.entry     = n.function;
+    function.interrupt = n.interrupt;
+    function.calls += n.calls;
+    function.self_cycles += n.self_cycles;
+    // a recursive call is already in the total of the outer one.
+    bool recursive = false;
+    for (u32 up = n.parent; up != 0 && !recursive; up = nodes_[up].parent) {
+      recursive = nodes_[up].function == n.function && nodes_[up].interrupt == n.interrupt;
+    }
+    if (!recursive) {
+      function.total_cycles += total[node];
+    }
+  }
+
+  std::vector<Function> result;
+  result.reserve(functions.size());
+  for (const auto& [key, function] : functions) {
+    result.push_back(function);
+  }
+  std::sort(result.begin(), result.end(), [](const Function& lhs, const Function& rhs) {
+    return lhs.self_cycles != rhs.self_cycles ? lhs.self_cycles > rhs.self_cycles : lhs.entry < rhs.entry;
+  });
+  return result;
+}
+
+std::string GuestProfiler::name(Location location) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%02x:%04x", location >> 16, location & 0xffff);
+  return buf;
+}
+
+std::string GuestProfiler::frameName(u32 node) const {
+  const auto& n = nodes_[node];
+  if (node == 0) {
+    return "root";
+  }
+  if (n.function == HALT) {
+    return "halt";
+  }
+  return n.interrupt ? name(n.function) + " (irq)" : name(n.function);
+}
+
+std::string GuestProfiler::foldedStacks() const {
+  std::string out;
+  std::vector<u32> stack;
+  for (u32 node = 0; node < nodes_.size(); node++) {
+    if (nodes_[node].self_cycles == 0) {
+      continue;
+    }
+    stack.clear();
+    for (u32 up = node; up != 0; up = nodes_[up].parent) {
+      stack.push_back(up);
+    }
+    out += frameName(0);
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+      out += ';';
+      out += frameName(*it);
+    }
+    out += ' ';
+    out += std::to_string(nodes_[node].self_cycles);
+    out += '\n';
+  }
+  return out;
+}
+
+bool GuestProfiler::writeFoldedStacks(const std::string& path) const {
+  std::ofstream file(path);
+  file << foldedStacks();
+  if (!file) {
+    GB_LOG(WARN) << "can not write " << path;
+    return false;
+  }
+  return true;
+}
+
+std::string GuestProfiler::report(u32 n) const {
+  std::string out;
+  char line[128];
+
+  std::vector<u16> opcodes(OPCODES);
+  for (u16 i = 0; i < OPCODES; i++) {
+    opcodes[i] = i;
+  }
+  std::stable_sort(opcodes.begin(), opcodes.end(),
+                   [this](u16 lhs, u16 rhs) { return opcodes_[lhs] > opcodes_[rhs]; });
+  snprintf(line, sizeof(line), "%-8s %14s\n", "opcode", "executions");
+  out += line;
+  for (u32 i = 0; i < n && i < OPCODES && opcodes_[opcodes[i]]; i++) {
+    u16 op = opcodes[i];
+    char opcode[8];
+    snprintf(opcode, sizeof(opcode), "%s%02x", op > 0xff ? "cb " : "", op & 0xff);
+    snprintf(line, sizeof(line), "%-8s %14llu\n", opcode, (unsigned long long) opcodes_[op]);
+    out += line;
+  }
+
+  snprintf(line, sizeof(line), "\n%-8s %14s %14s\n", "pc", "executions", "cycles");
+  out += line;
+  for (const auto& hotspot : hotspots(n)) {
+    snprintf(line, sizeof(line), "%-8s %14llu %14llu\n", name(hotspot.location).c_str(),
+             (unsigned long long) hotspot.count, (unsigned long long) hotspot.cycles);
+    out += line;
+  }
+
+  snprintf(line, sizeof(line), "\n%-14s %10s %14s %14s\n", "function", "calls", "self cycles",
+           "total cycles");
+  out += line;
+  auto functions = this->functions();
+  for (u32 i = 0; i < n && i < functions.size(); i++) {
+    const auto& function = functions[i];
+    snprintf(line, sizeof(line), "%-14s %10llu %14llu %14llu\n",
+             (name(function.entry) + (function.interrupt ? " (irq)" : "")).c_str(),
+             (unsigned long long) function.calls, (unsigned long long) function.self_cycles,
+             (unsigned long long) function.total_cycles);
+    out += line;
+  }
+  return out;
+}
+
+} // namespace gb
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/type.h"
+#include "common/utils.h"
+
+namespace gb {
+
+// Execution profile of the guest code: executions per opcode and per (bank, PC), and the cycles of
+// every guest call stack, rebuilt from the CALL/RST/interrupt and RET/RETI pairs. off by default,
+// the CPU checks a flag per instruction. it is not part of the save state.
+class GuestProfiler {
+public:
+  // bank << 16 | pc, the bank of 0x0000-0x7fff is the ROM bank mapped there, 0 for RAM.
+  using Location = u32;
+
+  static constexpr Location location(u16 bank, u16 pc) { return (u32) bank << 16 | pc; }
+
+  // opcodes 0x100-0x1ff are the CB prefixed ones.
+  static constexpr u16 OPCODES = 0x200;
+
+  // frames past it are not tracked, their cycles go to the deepest frame.
+  static constexpr u32 MAX_DEPTH = 256;
+
+  struct Hotspot {
+    Location location{};
+    u64 count{};
+    u64 cycles{};
+  };
+
+  struct Function {
+    Location entry{};
+    bool interrupt{}; // entered by an interrupt rather than a call
+    u64 calls{};
+    u64 self_cycles{};
+    u64 total_cycles{}; // with the functions it calls, recursion counted once
+  };
+
+  void enable() {
+    if (!enable_) {
+      reset();
+    }
+    enable_ = true;
+  }
+
+  void disable() { enable_ = false; }
+
+  INLINE bool enabled() const { return enable_; }
+
+  void reset();
+
+  // the instruction `opcode` at `from` executed and left the CPU at `to`.
+  // taken CALL/RST and RET/RETI are told apart from the untaken ones by the stack pointer.
+  void instruction(Location from, Location to, u16 opcode, u16 sp_before, u16 sp_after, u8 cycles);
+
+  // the CPU pushed PC and jumped to the handler at `handler`, SP is the one after the push.
+  void interrupt(Location handler, u16 sp, u8 cycles);
+
+  // cycles spent halted, counted in a "halt" frame of the current stack.
+  void halted(u8 cycles);
+
+  u64 opcodeCount(u16 opcode) const { return opcodes_[opcode]; }
+
+  // the `n` locations with the most cycles.
+  std::vector<Hotspot> hotspots(u32 n) const;
+
+  // by self cycles, most first.
+  std::vector<Function> functions() const;
+
+  // one line per call stack, "root;01:4000;00:0040 (irq) <cycles>", the input of flamegraph.pl
+  // and speedscope.
+  std::string foldedStacks() const;
+
+  bool writeFoldedStacks(const std::string& path) const;
+
+  // the top `n` opcodes, locations and functions as text.
+  std::string report(u32 n) const;
+
+  // "01:4a2f".
+  static std::string name(Location location);
+
+private:
+  static constexpr Location HALT = 1u << 31; // pseudo function of the halted cycles
+
+  struct Node {
+    u32 parent{};
+    Location function{};
+    bool interrupt{};
+    u64 calls{};
+    u64 self_cycles{};
+  };
+
+  struct Frame {
+    u32 node{};
+    u16 return_sp{}; // SP once the return address is popped
+  };
+
+  INLINE u32 current() const { return frames_.empty() ? 0 : frames_.back().node; }
+
+  u32 child(u32 parent, Location function, bool interrupt);
+
+  void call(Location function, bool interrupt, u16 return_sp);
+
+  void ret(u16 sp);
+
+  std::string frameName(u32 node) const;
+
+  bool enable_{};
+  u64 opcodes_[OPCODES]{};
+  std::unordered_map<Location, Hotspot> hotspots_;
+  // the call tree, a node is created after its parent. node 0 is the code running when the profile
+  // started, which has no known caller.
+  std::vector<Node> nodes_;
+  std::unordered_map<u64, u32> children_; // parent << 32 | function (| interrupt bit)
+  std::vector<Frame> frames_;
+};
+
+} // namespace gb
@@ -15,6 +15,68 @@ GB_API void GameBoyStop(GameBoy gb);
 GB_API void GameBoyDestroy(GameBoy gb);
 GB_API const char *GameBoyTextureBuffer(GameBoy gb);
 
+// record per-channel audio stems and the APU register trace,
+// files are written to `<prefix>.ch[1-4].pcm` and `<prefix>.apureg` when stopped.
+GB_API void GameBoyAPURecordStart(GameBoy gb);
+GB_API int GameBoyAPURecordStop(GameBoy gb, const char *prefix);
+
+// emulation speed multiplier (1 = real time, 0 = unlimited), turbo overrides it while enabled.
+GB_API void GameBoySpeed(GameBoy gb, float speed);
+GB_API void GameBoyTurbo(GameBoy gb, int enable);
+
+// `callback` is called from the emulation thread when a rumble cartridge (MBC5) switches its motor.
+typedef void (*GameBoyRumbleCallback)(void *user_data, int on);
+GB_API void GameBoyRumble(GameBoy gb, GameBoyRumbleCallback callback, void *user_data);
+
+// save states, see gb::GameBoy::saveState. stop or pause the emulation first.
+GB_API unsigned GameBoyStateSize(GameBoy gb);
+// return the bytes written, 0 if `size` is too small.
+GB_API unsigned GameBoySaveState(GameBoy gb, void *buffer, unsigned size);
+GB_API int GameBoyLoadState(GameBoy gb, const void *buffer, unsigned size);
+
+// go back up to `frames` frames, applied by the emulation thread at the next frame.
+GB_API void GameBoyRewind(GameBoy gb, unsigned frames);
+
+// button mask of gb::Joypad::Button, applied by the emulation thread at the next input frame.
+GB_API void GameBoyPress(GameBoy gb, unsigned buttons, int pressed);
+
+// input movies (see gb::Movie), started and stopped at the next input frame of the running emulation.
+GB_API void GameBoyMovieRecord(GameBoy gb);
+// stop playing, or stop recording and write the movie to `path`.
+GB_API void GameBoyMovieStop(GameBoy gb, const char *path);
+GB_API void GameBoyMoviePlay(GameBoy gb, const char *path);
+
+// headless copy of a running instance sharing its ROM, destroy it with GameBoyDestroy.
+GB_API GameBoy GameBoyFork(GameBoy gb);
+
+// lockstep instances of one game for reinforcement learning, see gb::VecEnv.
+// `threads` 0 uses every hardware thread.
+typedef void *GameBoyVecEnv;
+GB_API GameBoyVecEnv GameBoyVecEnvCreate(const char *game_path, unsigned size, unsigned threads);
+GB_API void GameBoyVecEnvDestroy(GameBoyVecEnv env);
+GB_API void GameBoyVecEnvReset(GameBoyVecEnv env);
+// `actions`: one button mask per instance.
+GB_API void GameBoyVecEnvStep(GameBoyVecEnv env, const unsigned char *actions);
+// size x 144 x 160 shades (0-3), updated in place by every step.
+GB_API const unsigned char *GameBoyVecEnvObservations(GameBoyVecEnv env);
+
+// per-thread calls and host time of the emulator subsystems, see src/common/profiler.h.
+// counted only in builds with GB_PROFILE, GameBoyProfileEnabled returns 0 otherwise.
+GB_API int GameBoyProfileEnabled(void);
+GB_API void GameBoyProfileReset(void);
+// a text table per thread, valid until the next call.
+GB_API const char *GameBoyProfileReport(void);
+
+// the last events of every thread (see src/common/trace.h) as Chrome trace JSON, recorded only in
+// builds with GB_TRACE, GameBoyTraceEnabled returns 0 otherwise. return 0 if `path` can not be written.
+GB_API int GameBoyTraceEnabled(void);
+GB_API int GameBoyTraceWrite(const char *path);
+
+// guest code profile (see gb::GuestProfiler), started and stopped at the next input frame.
+GB_API void GameBoyGuestProfileStart(GameBoy gb);
+// stop counting and write the call stacks in the folded format of flamegraph.pl to `path`.
+GB_API void GameBoyGuestProfileStop(GameBoy gb, const char *path);
+
 GB_API void print(const char *msg);
 
 #ifdef __cplusplus
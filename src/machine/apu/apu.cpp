@@ -4,9 +4,13 @@
 
 #include <cmath>
 
+#include "common/profiler.h"
+
 namespace gb {
 
 void APU::tick() {
+  GB_PROFILE_SCOPE(kAPU);
+  t_cycles_++;
   // bug here
   // it triggers by DIV register of timer when bit 4 goes from 1 to 0
   // we can set DIV to 0 to make it trigger faster,
@@ -48,15 +52,25 @@ void APU::tick() {
   channel3_.tick();
   channel4_.tick();
 
-  if ((++sample_buffer_counter_) == 87) {
+  if ((++sample_buffer_counter_) == SAMPLE_PERIOD) {
     sample_buffer_counter_ = 0;
+    const i16 outputs[]    = {channel1_.output(), channel2_.output(), channel3_.output(), channel4_.output()};
+    if (recorder_.recording()) [[unlikely]] {
+      recorder_.sample(outputs);
+    }
+
+    if (mute_ || (sample_phase_ += 1.f) < sample_step_) {
+      return;
+    }
+    sample_phase_ -= sample_step_;
+
     std::lock_guard lock(sample_buffer_mutex_);
     i32 left{};
     i32 right{};
 
-#define OUTPUT(CHANNEL, CHANNEL_IDX)             \
-  if (apu_reg_.CHANNEL##Enable(CHANNEL_IDX)) {   \
-    CHANNEL += channel##CHANNEL_IDX##_.output(); \
+#define OUTPUT(CHANNEL, CHANNEL_IDX)           \
+  if (apu_reg_.CHANNEL##Enable(CHANNEL_IDX)) { \
+    CHANNEL += outputs[CHANNEL_IDX - 1];       \
   }
 
     OUTPUT(left, 1);
@@ -78,6 +92,17 @@ void APU::tick() {
 #undef OUTPUT
 }
 
+void APU::playbackSpeed(f32 speed) {
+  std::lock_guard lock(sample_buffer_mutex_);
+  mute_ = speed < 1.f;
+  if (mute_) {
+    sample_buffer_.clear();
+  } else {
+    sample_step_  = speed;
+    sample_phase_ = 0;
+  }
+}
+
 void APU::audioDataCallback(ma_device *device, void *output, const void *input, ma_uint32 frame_count) {
   std::lock_guard lock(sample_buffer_mutex_);
 
@@ -113,6 +138,9 @@ u8 APU::get(u16 addr) const {
 }
 
 void APU::set(u16 addr, u8 val) {
+  if (recorder_.recording()) [[unlikely]] {
+    recorder_.registerWrite(t_cycles_, addr, val);
+  }
   switch (addr) {
     case 0xff10 ... 0xff14:
       channel1_.set(addr, val);
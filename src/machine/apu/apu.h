@@ -2,6 +2,7 @@
 
 #include <mutex>
 
+#include "apu_recorder.h"
 #include "channel1.h"
 #include "channel2.h"
 #include "channel3.h"
@@ -41,9 +42,30 @@ public:
 
   const Channel4& channel4() const { return channel4_; }
 
+  // per-instance noise seed, identical seed and inputs always produce identical samples.
+  void noiseSeed(u16 seed) { channel4_.lfsrSeed(seed); }
+
+  APURecorder& recorder() { return recorder_; }
+
+  // keep one of every `speed` samples when fast forwarding so the playback buffer
+  // neither overflows nor lags behind, mute when slower than real time or unlimited (0).
+  void playbackSpeed(f32 speed);
+
+  u64 cycles() const { return t_cycles_; }
+
+  // the playback buffer is not part of the state.
+  void serialize(StateSerializer& s) {
+    s(apu_reg_, t_cycle_counter_, t_cycles_, channel1_, channel2_, channel3_, channel4_,
+      sample_buffer_counter_);
+  }
+
 private:
+  // one sample every 87 T-cycles, roughly 48 kHz.
+  static constexpr u32 SAMPLE_PERIOD = 87;
+
   APUGlobalRegister apu_reg_;
   u16 t_cycle_counter_{};
+  u64 t_cycles_{};
 
   Channel1 channel1_;
   Channel2 channel2_;
@@ -52,7 +74,12 @@ private:
 
   CircleBuffer<i16> sample_buffer_{65535};
   u32 sample_buffer_counter_{};
+  f32 sample_step_{1.f};
+  f32 sample_phase_{};
+  bool mute_{};
   std::mutex sample_buffer_mutex_;
+
+  APURecorder recorder_{SAMPLE_PERIOD};
 };
 
 } // namespace gb
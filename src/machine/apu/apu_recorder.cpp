@@ -0,0 +1,82 @@
+#include "apu_recorder.h"
+
+#include <fstream>
+
+#include "common/logger.h"
+
+namespace gb {
+
+void APURecorder::start(u64 now) {
+  std::lock_guard lock(mutex_);
+  for (auto &stem: stems_) {
+    stem.clear();
+  }
+  trace_.clear();
+  trace_.insert(trace_.end(), std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC));
+  trace_.push_back(TRACE_VERSION);
+  for (u8 i = 0; i < 4; i++) {
+    trace_.push_back((sample_period_ >> (i * 8)) & 0xff);
+  }
+  for (u8 i = 0; i < 8; i++) {
+    trace_.push_back((now >> (i * 8)) & 0xff);
+  }
+  start_cycle_      = now;
+  last_write_cycle_ = now;
+  recording_        = true;
+}
+
+void APURecorder::stop() {
+  std::lock_guard lock(mutex_);
+  recording_ = false;
+}
+
+void APURecorder::sample(const i16 (&outputs)[CHANNEL_COUNT]) {
+  std::lock_guard lock(mutex_);
+  if (!recording()) {
+    return;
+  }
+  for (u8 i = 0; i < CHANNEL_COUNT; i++) {
+    stems_[i].push_back(outputs[i]);
+  }
+}
+
+void APURecorder::registerWrite(u64 now, u16 addr, u8 val) {
+  std::lock_guard lock(mutex_);
+  if (!recording()) {
+    return;
+  }
+  writeVarint(now - last_write_cycle_);
+  trace_.push_back(addr - TRACE_BASE);
+  trace_.push_back(val);
+  last_write_cycle_ = now;
+}
+
+void APURecorder::writeVarint(u64 val) {
+  // LEB128, most of the deltas fit in 1-3 bytes.
+  do {
+    u8 byte = val & 0x7f;
+    val >>= 7;
+    trace_.push_back(val ? byte | 0x80 : byte);
+  } while (val);
+}
+
+bool APURecorder::save(const std::string &prefix) {
+  std::lock_guard lock(mutex_);
+  auto write = [](const std::string &path, const std::vector<u8> &data) {
+    std::ofstream os(path, std::ios::binary);
+    if (!os.is_open()) {
+      GB_LOG(WARN) << "can not open " << path;
+      return false;
+    }
+    os.write((const char *) data.data(), (std::streamsize) data.size());
+    return os.good();
+  };
+
+  bool ok = write(prefix + ".apureg", trace_);
+  for (u8 i = 0; i < CHANNEL_COUNT; i++) {
+    ok &= write(prefix + ".ch" + std::to_string(i + 1) + ".pcm", stems_[i]);
+  }
+  return ok;
+}
+
+} // namespace gb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Records the raw output of every channel (before panning / mixing) and
+// a cycle-timestamped trace of the writes to 0xFF10-0xFF3F.
+//
+// stem file (<prefix>.chN.pcm): unsigned 8-bit mono, one sample (0-15) per APU sample.
+// register trace (<prefix>.apureg):
+//   "GBAT" | u8 version | u32 sample period (T-cycles) | u64 start cycle
+//   then for each write: varint delta T-cycles | u8 (addr - 0xff10) | u8 value
+class APURecorder {
+public:
+  static constexpr u8 CHANNEL_COUNT   = 4;
+  static constexpr u8 TRACE_VERSION   = 1;
+  static constexpr char TRACE_MAGIC[] = {'G', 'B', 'A', 'T'};
+  static constexpr u16 TRACE_BASE     = 0xff10;
+
+  explicit APURecorder(u32 sample_period) : sample_period_(sample_period) {}
+
+  void start(u64 now);
+
+  void stop();
+
+  bool recording() const { return recording_.load(std::memory_order_relaxed); }
+
+  void sample(const i16 (&outputs)[CHANNEL_COUNT]);
+
+  void registerWrite(u64 now, u16 addr, u8 val);
+
+  // write stems and register trace, return false if any file can not be written.
+  bool save(const std::string &prefix);
+
+  const std::vector<u8> &stem(u8 channel) const { return stems_[channel]; }
+
+  const std::vector<u8> &registerTrace() const { return trace_; }
+
+private:
+  void writeVarint(u64 val);
+
+  const u32 sample_period_;
+  std::atomic<bool> recording_{};
+  std::mutex mutex_;
+
+  u64 start_cycle_{};
+  u64 last_write_cycle_{};
+  std::vector<u8> stems_[CHANNEL_COUNT];
+  std::vector<u8> trace_;
+};
+
+} // namespace gb
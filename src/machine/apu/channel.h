@@ -33,6 +33,10 @@ public:
 
   void nrx4(u8 val) { nrx4_ = val; }
 
+  void serialize(StateSerializer& s) {
+    s(channel_enable_, length_timer_, frame_sequencer_, period_timer_, nrx3_, nrx4_);
+  }
+
 protected:
   bool channel_enable_{};
   LengthTimer length_timer_;
@@ -86,6 +86,11 @@ public:
 
   u8 sweepIndividualStep() const { return nr10_ & 0x7; }
 
+  void serialize(StateSerializer& s) {
+    Channel2::serialize(s);
+    s(nr10_, frequency_, sweep_enable_, sweep_timer_, shadow_frequency_);
+  }
+
 private:
   u8 nr10_{}; // sweep
 
@@ -76,6 +76,11 @@ public:
 
   Envelope& envelope() { return envelope_; }
 
+  void serialize(StateSerializer& s) {
+    Channel::serialize(s);
+    s(wave_duty_position_, envelope_);
+  }
+
 protected:
   // https://gbdev.io/pandocs/Audio_Registers.html#ff11--nr11-channel-1-length-timer--duty-cycle
   static constexpr u8 wave_duty_[][8] = {
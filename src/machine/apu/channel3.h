@@ -90,6 +90,11 @@ public:
 
   LengthTimer& lengthTimer() { return length_timer_; }
 
+  void serialize(StateSerializer& s) {
+    Channel::serialize(s);
+    s(nr30_, nr32_, wave_pattern_ram_, wave_position_);
+  }
+
 
 private:
   u8 nr30_{}; // 0xff1a
@@ -9,7 +9,12 @@ namespace gb {
 
 class Channel4 : public Channel {
 public:
-  using Channel::Channel;
+  // https://gbdev.io/pandocs/Audio_details.html#noise-channel-ch4
+  // triggering the channel always reloads all 15 bits of the LFSR with ones.
+  static constexpr u16 LFSR_RELOAD = 0x7fff;
+
+  // `seed` is the power-on LFSR content, before the first trigger.
+  explicit Channel4(u16 seed = LFSR_RELOAD) : lfsr_(seed & LFSR_RELOAD) {}
 
   void tick() override {
     if (period_timer_ == 0) {
@@ -41,7 +46,7 @@ public:
   void trigger() override {
     envelope_.trigger();
     period_timer_   = divisors_[clockDivisor()] << clockShift();
-    lfsr_           = rand();
+    lfsr_           = LFSR_RELOAD;
     channel_enable_ = dacEnable();
   }
 
@@ -101,13 +106,20 @@ public:
 
   Envelope& envelope() { return envelope_; }
 
+  void lfsrSeed(u16 seed) { lfsr_ = seed & LFSR_RELOAD; }
+
+  void serialize(StateSerializer& s) {
+    Channel::serialize(s);
+    s(lengthTimer_, envelope_, lfsr_);
+  }
+
 private:
   static constexpr u8 divisors_[] = {8, 16, 32, 48, 64, 80, 96, 112};
 
   LengthTimer lengthTimer_; // nr41 0xff20
   Envelope envelope_;       // nr42 0xff21 lfsr
 
-  u16 lfsr_;
+  u16 lfsr_{};
 };
 
 } // namespace gb
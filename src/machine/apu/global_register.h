@@ -35,6 +35,11 @@ public:
 
   u8& apuDIV() { return apu_div_; }
 
+  void serialize(StateSerializer& s) {
+    Memory::serialize(s);
+    s(apu_div_);
+  }
+
 private:
   APU* apu_{};
 
@@ -54,6 +54,8 @@ public:
 
   u8 nrx1() const { return nrx1_; }
 
+  void serialize(StateSerializer& s) { s(nrx1_, enable_, length_timer_); }
+
 private:
   u8 validBit() const { return max_length_ == 64 ? 0x3f : 0xff; }
 
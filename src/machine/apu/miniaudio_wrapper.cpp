@@ -34,6 +34,8 @@ void MiniAudioWrapper::init() {
 
 void MiniAudioWrapper::data_callback(ma_device* device, void* output, const void* input,
                                      ma_uint32 frame_count) {
+  GB_TRACE_THREAD("audio");
+  GB_TRACE_SCOPE("audio callback");
   auto* gb = static_cast<GameBoy*>(device->pUserData);
   if (!gb) [[unlikely]] {
     return;
@@ -63,6 +63,8 @@ public:
 
   u8 currentVolume() const { return period_timer_ > 0 ? current_volume_ : initialVolume(); }
 
+  void serialize(StateSerializer& s) { s(nrx2, period_timer_, current_volume_); }
+
 private:
   u8 nrx2{};
 
@@ -3,6 +3,8 @@
 #include <memory>
 #include <string>
 
+#include "common/profiler.h"
+#include "common/trace.h"
 #include "common/type.h"
 
 namespace gb {
@@ -432,7 +434,8 @@ DEF_INST_END
 
 DEF_INST("LD B,B", 0x40, 1, 4)
 // LD B B
-// nothing to do.
+// nothing to do, but test ROMs use it as a breakpoint.
+cpu->breakpoint(true);
 DEF_INST_END
 
 DEF_INST("LD B,C", 0x41, 1, 4)
@@ -1493,6 +1496,7 @@ static const std::function<u8(CPU *)> *instruction_table() {
 }
 
 u8 CPU::update() {
+  GB_PROFILE_SCOPE(kCPU);
   if (halt()) {
     // https://gbdev.io/pandocs/halt.html#halt-bug
     // todo: if IME() not set but ie/if is set, we need to handle this bug.
@@ -1502,14 +1506,24 @@ u8 CPU::update() {
       // idle
     }
     tick();
+    if (guest_profiler_.enabled()) [[unlikely]] {
+      guest_profiler_.halted(4);
+    }
     return 4;
   } else {
     // handle interrupt first
     u8 irq = handleInterrupt();
     if (irq != 0) {
+      if (guest_profiler_.enabled()) [[unlikely]] {
+        guest_profiler_.interrupt(location(pc_), sp_, irq);
+      }
       return irq;
     }
     disassembler_.disassemble(pc_);
+    instructions_++;
+    if (guest_profiler_.enabled()) [[unlikely]] {
+      return profiledUpdate();
+    }
     u8 inst_idx = imm8();
     GB_ASSERT(inst_idx <= 255 || inst_idx >= 0);
     return instruction_table()[inst_idx](this);
@@ -1517,6 +1531,25 @@ u8 CPU::update() {
   GB_UNREACHABLE();
 }
 
+u8 CPU::profiledUpdate() {
+  u16 pc     = pc_;
+  u16 sp     = sp_;
+  auto from  = location(pc);
+  u8 op      = imm8();
+  u16 opcode = op;
+  if (op == 0xCB) {
+    // peeked, the instruction fetches it itself.
+    opcode = 0x100 | memory_bus_->get(pc_);
+  }
+  u8 cycles = instruction_table()[op](this);
+  guest_profiler_.instruction(from, location(pc_), opcode, sp, sp_, cycles);
+  return cycles;
+}
+
+GuestProfiler::Location CPU::location(u16 pc) const {
+  return GuestProfiler::location(pc < VRAM_BASE ? memory_bus_->cartridge_->romBank(pc) : 0, pc);
+}
+
 u8 CPU::handleInterrupt() {
   if (!IME()) {
     return 0;
@@ -1540,6 +1573,7 @@ u8 CPU::handleInterrupt() {
   // https://gbdev.io/pandocs/Interrupts.html#interrupt-priorities
   const u8 interrupt_bit = __builtin_ctz(interrupt_mask);
   if (interrupt_bit < sizeof(interrupt_table) / sizeof(interrupt_table[0])) {
+    GB_TRACE_INSTANT(kIRQ_SERVICED, interruptName(interrupt_bit), PC());
     push16(PC());
     PC(interrupt_table[interrupt_bit]);
     memory_bus_->set(IF_BASE, memory_bus_->get(IF_BASE) & ~(1 << interrupt_bit));
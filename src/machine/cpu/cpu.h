@@ -3,6 +3,7 @@
 #include "common/logger.h"
 #include "common/type.h"
 #include "debugger/disassembler.h"
+#include "debugger/guest_profiler.h"
 #include "interrupt.h"
 #include "machine/memory/memory_accessor.h"
 #include "machine/memory/memory_bus.h"
@@ -144,6 +145,12 @@ public:
     ime_ = val;
   }
 
+  // LD B,B, the software breakpoint test ROMs (mealybug-tearoom, dmg-acid2) execute when done.
+  // set by the instruction, cleared by the host. not part of the save state.
+  INLINE bool breakpoint() const { return breakpoint_; }
+
+  INLINE void breakpoint(bool val) { breakpoint_ = val; }
+
   INLINE u8 imm8() {
     auto ret = get(pc_++);
     return ret;
@@ -390,6 +397,8 @@ public:
 
   u8 &timingChecker() { return timing_checker_; }
 
+  void serialize(StateSerializer &s) { s(af_, bc_, de_, hl_, pc_, sp_, halt_, ime_, interrupt_delay_); }
+
   void memoryBus(MemoryBus *memory_bus) {
     memory_bus_ = memory_bus;
     disassembler_.memoryBus(memory_bus);
@@ -397,18 +406,32 @@ public:
 
   Disassembler &disassembler() { return disassembler_; }
 
+  // enable it from the emulation thread (GameBoy::post) or while it is stopped.
+  GuestProfiler &guestProfiler() { return guest_profiler_; }
+
+  // instructions executed since construction, interrupt dispatch and halted cycles excluded.
+  u64 instructions() const { return instructions_; }
+
 private:
+  // execute an instruction and count it in the guest profiler.
+  u8 profiledUpdate();
+
+  GuestProfiler::Location location(u16 pc) const;
+
   u16 af_{}, bc_{}, de_{}, hl_{};
   u16 pc_{}, sp_{};
   bool halt_{};
   bool ime_{};
   u8 interrupt_delay_{};
+  bool breakpoint_{};
+  u64 instructions_{};
 
   MemoryBus *memory_bus_{};
 
   mutable u8 timing_checker_{};
 
   Disassembler disassembler_;
+  GuestProfiler guest_profiler_;
 };
 
 } // namespace gb
@@ -0,0 +1,82 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace gb {
+
+u64 FramePacer::now() {
+#ifdef __linux__
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1'000'000'000ULL + ts.tv_nsec;
+#else
+  auto duration = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+#endif
+}
+
+void FramePacer::sleepUntil(u64 deadline) {
+#ifdef __linux__
+  // absolute deadline, an early wake up (signal) does not push the deadline back.
+  timespec ts{(time_t) (deadline / 1'000'000'000), (long) (deadline % 1'000'000'000)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+  }
+#else
+  u64 current = now();
+  if (deadline > current) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - current));
+  }
+#endif
+}
+
+void FramePacer::reset() {
+  start_     = now();
+  last_wake_ = start_;
+  deadline_  = 0;
+  std::lock_guard lock(stats_mutex_);
+  stats_.drift_ns = 0;
+}
+
+void FramePacer::wait(f64 frame_ns) {
+  deadline_ += frame_ns;
+  u64 deadline = start_ + (u64) deadline_;
+  u64 current  = now();
+
+  if (current + spin_ns_ < deadline) {
+    sleepUntil(deadline - spin_ns_);
+  }
+  while ((current = now()) < deadline) {
+    // spin the last microseconds
+  }
+
+  // the spin ends a few ns past the deadline, only an oversleep beyond the spin window is late.
+  bool late   = current - deadline > spin_ns_;
+  bool resync = current - deadline > MAX_LAG_NS;
+  if (resync) {
+    // the host can not keep up (or was suspended), do not try to catch up.
+    start_    = current;
+    deadline_ = 0;
+  }
+
+  u64 frame_time = current - last_wake_;
+  last_wake_     = current;
+
+  std::lock_guard lock(stats_mutex_);
+  stats_.frames++;
+  stats_.late_frames += late;
+  stats_.resyncs += resync;
+  stats_.drift_ns      = (i64) (current - start_) - (i64) deadline_;
+  stats_.last_frame_ns = frame_time;
+  stats_.max_frame_ns  = std::max(stats_.max_frame_ns, frame_time);
+  stats_.mean_frame_ns += (frame_time - stats_.mean_frame_ns) / stats_.frames;
+  stats_.histogram[std::min<u64>(frame_time / BUCKET_NS, HISTOGRAM_BUCKETS - 1)]++;
+}
+
+} // namespace gb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mutex>
+
+#include "common/type.h"
+
+namespace gb {
+
+// Paces emulated frames against absolute deadlines on the monotonic clock.
+// Sleeps until shortly before the deadline and spins for the rest, so
+// the wake up jitter of the OS timer does not show up in the frame time.
+class FramePacer {
+public:
+  static constexpr f64 FRAME_RATE        = 4'194'304.0 / 70'224; // 59.7275 Hz
+  static constexpr u32 HISTOGRAM_BUCKETS = 64;
+  static constexpr u64 BUCKET_NS         = 500'000; // 0.5 ms, the last bucket collects the rest
+
+  struct Stats {
+    u64 frames{};
+    u64 late_frames{}; // woke up more than the spin window after the deadline, the sleep overshot
+    u64 resyncs{};     // fell too far behind, deadline dropped
+    i64 drift_ns{};    // wall time - emulated time since the last resync
+    u64 last_frame_ns{};
+    u64 max_frame_ns{};
+    f64 mean_frame_ns{};
+    u32 histogram[HISTOGRAM_BUCKETS]{};
+  };
+
+  // restart from now, e.g. after a pause.
+  void reset();
+
+  // block until the end of a frame lasting `frame_ns` of wall time.
+  void wait(f64 frame_ns);
+
+  void spinWindow(u64 ns) { spin_ns_ = ns; }
+
+  Stats stats() const {
+    std::lock_guard lock(stats_mutex_);
+    return stats_;
+  }
+
+  static u64 now();
+
+private:
+  static void sleepUntil(u64 deadline);
+
+  static constexpr u64 MAX_LAG_NS = 100'000'000;
+
+  u64 spin_ns_{200'000};
+  u64 start_{};
+  u64 last_wake_{};
+  f64 deadline_{}; // ns since `start_`, kept in floating point so fractional frames don't drift
+
+  mutable std::mutex stats_mutex_;
+  Stats stats_;
+};
+
+} // namespace gb
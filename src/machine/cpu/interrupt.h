@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/trace.h"
 #include "common/type.h"
 #include "machine/memory/memory_accessor.h"
 
@@ -13,6 +14,11 @@ enum InterruptType : u8 {
   kJOYPAD = 4,
 };
 
+inline const char *interruptName(u8 interrupt_type) {
+  static constexpr const char *NAMES[] = {"vblank", "lcd stat", "timer", "serial", "joypad"};
+  return NAMES[interrupt_type];
+}
+
 template<u16 LO, u16 HI>
 class Interrupt : public Memory<LO, HI> {
 public:
@@ -20,6 +26,7 @@ public:
     u8 val = Memory<LO, HI>::get(LO);
     val    = clearBitN(val, interrupt_type) | (1 << interrupt_type);
     Memory<LO, HI>::set(LO, val);
+    GB_TRACE_INSTANT(kIRQ_RAISED, interruptName(interrupt_type), interrupt_type);
   }
 };
 
@@ -1,19 +1,40 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <thread>
 
+#include "common/trace.h"
 #include "common/type.h"
+#include "frame_pacer.h"
+#include "scheduler.h"
 
 namespace gb {
 
+// Runs the emulation in slices of one frame, the wall clock is only
+// consulted between two slices.
 class RTC {
 public:
-  using TimerTask = std::function<u8()>;
+  // execute at least `budget` T-cycles, return the T-cycles actually executed.
+  using CPUTask                         = std::function<u64(u64 budget)>;
+  // called on the emulation thread when the effective speed changes, 0 means unlimited.
+  using SpeedObserver                   = std::function<void(f32 speed)>;
 
-  void addTask(const TimerTask &task) { tasks_.push_back(task); }
+  static constexpr u32 FREQUENCY        = 4'194'304;
+  static constexpr u32 CYCLES_PER_FRAME = 70'224;
+  static constexpr f32 MIN_SPEED        = 0.25f;
+  static constexpr f32 MAX_SPEED        = 16.f;
+  static constexpr f32 UNLIMITED_SPEED  = 0.f;
+
+  void cpuTask(const CPUTask &task) { cpu_task_ = task; }
+
+  void speedObserver(const SpeedObserver &observer) { speed_observer_ = observer; }
+
+  Scheduler &scheduler() { return scheduler_; }
 
   void stop() {
     {
@@ -30,9 +51,12 @@ public:
 
   bool stopped() const { return stop_; }
 
+  // returns once the slice in flight is done, the caller may then step() the emulation itself.
+  // must not be called from the emulation thread.
   void pause() {
-    std::lock_guard<std::mutex> lock(pause_mutex_);
+    std::unique_lock<std::mutex> lock(pause_mutex_);
     pause_ = true;
+    idle_cv_.wait(lock, [&] { return idle_; });
   }
 
   bool paused() const { return pause_; }
@@ -53,48 +77,89 @@ public:
 
   void cpuSpeedLock(bool v) { unlock_cpu_speed_ = v; }
 
+  // real time multiplier, 1 is the real hardware speed.
+  void speed(f32 multiplier) {
+    speed_ = multiplier == UNLIMITED_SPEED ? UNLIMITED_SPEED : std::clamp(multiplier, MIN_SPEED, MAX_SPEED);
+  }
+
+  f32 speed() const { return speed_; }
+
+  // fast forward while held, e.g. bound to a key.
+  void turbo(bool hold) { turbo_ = hold; }
+
+  void turboSpeed(f32 multiplier) { turbo_speed_ = std::clamp(multiplier, MIN_SPEED, MAX_SPEED); }
+
+  f32 effectiveSpeed() const {
+    if (unlock_cpu_speed_) {
+      return UNLIMITED_SPEED;
+    }
+    return turbo_ ? turbo_speed_.load() : speed_.load();
+  }
+
   u64 cpuSpeed() const { return cpu_speed_; }
 
+  // run until the emulated clock reaches `target` T-cycles, no pacing.
+  u64 runUntil(u64 target) {
+    u64 begin = scheduler_.now();
+    while (scheduler_.now() < target) {
+      u64 until = std::min(target, scheduler_.nextDeadline());
+      scheduler_.advance(cpu_task_(until - scheduler_.now()));
+    }
+    return scheduler_.now() - begin;
+  }
+
+  u64 step(u64 cycles) { return runUntil(scheduler_.now() + cycles); }
+
   void run() {
+    GB_TRACE_THREAD("emulation");
     stop_ = false;
     while (!stop_) {
-      // init time_accumulate_ to current time
-      time_accumulate_ = getNS();
-
       {
         std::unique_lock<std::mutex> lock(pause_mutex_);
+        idle();
         pause_cv_.wait(lock, [&] { return !pause_ || stop_; });
 
         if (stop_) {
           break;
         }
+        idle_ = false;
       }
 
+      pacer_.reset();
+      // keep the slices aligned to frame boundaries of the emulated clock.
+      u64 slice_end = scheduler_.now() - scheduler_.now() % CYCLES_PER_FRAME;
+
       while (!pause_) {
+        f32 speed = effectiveSpeed();
+        if (speed != current_speed_) {
+          current_speed_ = speed;
+          pacer_.reset();
+          if (speed_observer_) {
+            speed_observer_(speed);
+          }
+        }
+
+        slice_end += CYCLES_PER_FRAME;
+        u64 t_cycle = 0;
+        {
+          GB_TRACE_SCOPE("emulate");
+          t_cycle = runUntil(slice_end);
+        }
         auto now = getNS();
+        calculateCPUSpeed(t_cycle, now);
 
-        if (unlock_cpu_speed_) {
-          for (const auto &task: tasks_) {
-            calculateCPUSpeed(task(), now);
-          }
-        } else {
-          if (now >= time_accumulate_) {
-            for (const auto &task: tasks_) {
-              // Only CPU will return T-cycle, other tasks will return 0.
-              u8 t_cycle = task();
-              calculateCPUSpeed(t_cycle, now);
-              time_accumulate_ += t_cycle * (u64) SEQ;
-            }
-          } else {
-            // sleep until next cycle
-            // it depends on the CPU speed, if the host CPU is too low
-            // it may cause the emulator to run slower than the real speed.
-            // to fixed, just decrease the `sleep` value.
-            std::this_thread::sleep_for(std::chrono::nanoseconds((u64) SEQ));
-          }
+        if (speed == UNLIMITED_SPEED) {
+          // let the UI thread breathe between two slices.
+          std::this_thread::yield();
+          continue;
         }
+
+        GB_TRACE_SCOPE("pace");
+        pacer_.wait(t_cycle * SEQ / speed);
       }
     }
+    std::lock_guard<std::mutex> lock(pause_mutex_);
+    idle();
   }
 
   void runWithNewThread() {
@@ -104,22 +169,35 @@ public:
     thread_ = std::thread(&RTC::run, this);
   }
 
+  FramePacer::Stats pacerStats() const { return pacer_.stats(); }
+
   void calculateCPUSpeed(u64 cycle, u64 now) {
     t_cycle_count_ += cycle;
     auto duration = now - last_update_;
 
     if (duration >= 1e9) { // 1 second in nanoseconds
-      cpu_speed_     = t_cycle_count_;
+      // the count grows by whole frames, scale it to exactly one second.
+      cpu_speed_     = t_cycle_count_ * 1e9 / duration;
       t_cycle_count_ = 0;
       last_update_   = now;
     }
   }
 
 private:
-  static constexpr u32 FREQUENCY = 4'194'304;
-  static constexpr f64 SEQ       = (1.0 / FREQUENCY) * 1e9;
-  u64 time_accumulate_{};
+  // with pause_mutex_ held.
+  void idle() {
+    idle_ = true;
+    idle_cv_.notify_all();
+  }
+
+  static constexpr f64 SEQ = (1.0 / FREQUENCY) * 1e9;
+  FramePacer pacer_;
   std::atomic<bool> unlock_cpu_speed_{};
+  std::atomic<f32> speed_{1.f};
+  std::atomic<f32> turbo_speed_{4.f};
+  std::atomic<bool> turbo_{};
+  f32 current_speed_{1.f};
+  SpeedObserver speed_observer_;
 
   u64 cpu_speed_{};
   u64 t_cycle_count_{};
@@ -128,12 +206,15 @@ private:
 
   std::thread thread_;
 
-  std::vector<TimerTask> tasks_;
+  CPUTask cpu_task_;
+  Scheduler scheduler_;
 
-  bool stop_{true};
+  std::atomic<bool> stop_{true};
   std::atomic<bool> pause_{};
   std::condition_variable pause_cv_;
   std::mutex pause_mutex_;
+  bool idle_{true}; // the run loop is not inside a slice, guarded by pause_mutex_
+  std::condition_variable idle_cv_;
 };
 
 } // namespace gb
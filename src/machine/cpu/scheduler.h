@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "common/type.h"
+#include "common/utils.h"
+
+namespace gb {
+
+// Event queue timestamped in emulated T-cycles.
+// Tasks due at the same cycle run in priority order, then in registration order.
+class Scheduler {
+public:
+  using Task   = std::function<void()>;
+  using TaskId = u32;
+
+  enum class Priority : u8 {
+    kHIGH = 0, // e.g. input, must be observed by the next instruction
+    kNORMAL,
+    kLOW, // e.g. stats, autosave
+  };
+
+  static constexpr u64 NEVER = ~0ULL;
+
+  // the first run is `period` cycles from now.
+  TaskId addPeriodicTask(u64 period, Priority priority, const Task &task) {
+    GB_ASSERT(period > 0);
+    TaskId id = tasks_.size();
+    tasks_.push_back({task, period, clock(), priority, true});
+    queue_.push({now_ + period, priority, id});
+    return id;
+  }
+
+  void removeTask(TaskId id) {
+    if (id < tasks_.size()) {
+      tasks_[id].active = false;
+    }
+  }
+
+  u64 now() const { return now_; }
+
+  // the clock the tasks are aligned on, now() until rebase() moves it.
+  u64 clock() const { return now_ + offset_; }
+
+  // the emulated clock jumped to `clock` (a state was loaded): every task runs next where it would
+  // if the clock had always been there, so a loaded machine runs its tasks at the same cycles as
+  // the one which saved. now() does not move. may be called from a running task, `clock` is then
+  // the clock at the end of the advance() in progress, which the CPU already ran up to.
+  void rebase(u64 clock) {
+    offset_ = clock - target_;
+    queue_  = {};
+    for (TaskId id = 0; id < tasks_.size(); id++) {
+      const auto &entry = tasks_[id];
+      if (!entry.active) {
+        continue;
+      }
+      u64 runs = clock >= entry.origin ? (clock - entry.origin) / entry.period + 1 : 1;
+      queue_.push({entry.origin + runs * entry.period - offset_, entry.priority, id});
+    }
+    rebased_ = true;
+  }
+
+  u64 nextDeadline() {
+    dropInactive();
+    return queue_.empty() ? NEVER : queue_.top().deadline;
+  }
+
+  // move the clock forward and run every task which is due,
+  // `now()` is the deadline of the running task while it runs.
+  void advance(u64 cycles) {
+    u64 target = now_ + cycles;
+    target_    = target;
+    while (nextDeadline() <= target) {
+      Event event = queue_.top();
+      queue_.pop();
+      now_     = std::max(now_, event.deadline);
+      rebased_ = false;
+      tasks_[event.id].task();
+      // the task may remove itself, or rebase() queued it again.
+      if (tasks_[event.id].active && !rebased_) {
+        queue_.push({event.deadline + tasks_[event.id].period, event.priority, event.id});
+      }
+    }
+    now_ = target;
+  }
+
+private:
+  struct Entry {
+    Task task;
+    u64 period{};
+    u64 origin{}; // clock() when added
+    Priority priority{};
+    bool active{};
+  };
+
+  struct Event {
+    u64 deadline{};
+    Priority priority{};
+    TaskId id{};
+
+    // std::priority_queue is a max heap, invert the order.
+    bool operator<(const Event &rhs) const {
+      if (deadline != rhs.deadline) return deadline > rhs.deadline;
+      if (priority != rhs.priority) return priority > rhs.priority;
+      return id > rhs.id;
+    }
+  };
+
+  void dropInactive() {
+    while (!queue_.empty() && !tasks_[queue_.top().id].active) {
+      queue_.pop();
+    }
+  }
+
+  u64 now_{};
+  u64 target_{}; // now() once the advance() in progress returns
+  u64 offset_{}; // clock() - now()
+  bool rebased_{};
+  std::deque<Entry> tasks_; // stable references, tasks may be added while running
+  std::priority_queue<Event> queue_;
+};
+
+} // namespace gb
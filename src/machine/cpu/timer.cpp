@@ -1,11 +1,13 @@
 #include "timer.h"
 
+#include "common/profiler.h"
 #include "machine/cpu/interrupt.h"
 #include "machine/memory/memory_bus.h"
 
 namespace gb {
 
 void Timer::tick() {
+  GB_PROFILE_SCOPE(kTIMER);
   if (tima_reload_counter_ > 0) {
     tima_reload_counter_--;
     if (tima_reload_counter_ == 0) {
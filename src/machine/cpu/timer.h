@@ -58,6 +58,11 @@ public:
 
   void memoryBus(MemoryBus* memory_bus) { memory_bus_ = memory_bus; }
 
+  void serialize(StateSerializer& s) {
+    Memory::serialize(s);
+    s(div_, tima_reload_counter_);
+  }
+
 private:
   u16 div_{};
   u8 tima_reload_counter_{};
@@ -1,5 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
 #include "cartridge/cartridge.h"
 #include "cartridge/cartridge_factory.h"
 #include "machine/apu/apu.h"
@@ -7,46 +16,328 @@
 #include "machine/cpu/cpu.h"
 #include "machine/cpu/rtc.h"
 #include "machine/cpu/timer.h"
+#include "machine/movie.h"
 #include "machine/ppu/ppu.h"
+#include "machine/rewind_buffer.h"
 
 namespace gb {
 
+struct GameBoyOptions {
+  bool audio{true};            // open the playback device, off for headless instances
+  bool battery_save{true};     // map <rom>.sav for battery backed cartridges, if no other instance has
+  u64 rewind_budget{32 << 20}; // bytes of rewind history, 0 disables rewinding
+};
+
 class GameBoy {
 public:
   ~GameBoy() { delete cartridge_; }
 
-  explicit GameBoy(const std::string& game)
-      : cartridge_(CartridgeFactory::Create(game)),
-        miniaudio_wrapper(this) {
+  explicit GameBoy(const std::string& game, const GameBoyOptions& options = {})
+      : GameBoy(CartridgeFactory::Create(game, options.battery_save), options) {}
+
+  // a headless copy of this machine, sharing the ROM mapping and never touching the save file.
+  // the state is copied through a save state, every page is copied eagerly.
+  std::unique_ptr<GameBoy> fork() {
+    GameBoyOptions options{.audio = false, .battery_save = false, .rewind_budget = 0};
+    auto* cartridge = CartridgeFactory::Create(cartridge_->romImage(), options.battery_save);
+    std::unique_ptr<GameBoy> child(new GameBoy(cartridge, options));
+    thread_local std::vector<u8> state;
+    state.resize(stateSize());
+    saveState(state);
+    child->loadState(state);
+    return child;
+  }
+
+  static constexpr u8 MAX_FRAME_SKIP     = 16;
+  static constexpr u64 SAVE_FLUSH_PERIOD = 5ULL * RTC::FREQUENCY; // 5 s of emulated time
+  static constexpr u32 REWIND_INTERVAL   = 4;                      // frames between two snapshots
+  static constexpr u32 REWIND_KEYFRAME   = 60;                     // snapshots between two keyframes
+
+  // save state: "GBST" | u16 version | u16 ROM global checksum | CPU | bus | timer | serial
+  //             | joypad | PPU | APU | cartridge, every value little endian.
+  static constexpr u8 STATE_MAGIC[]  = {'G', 'B', 'S', 'T'};
+  static constexpr u16 STATE_VERSION = 1;
+
+  // size of a save state of this game, it does not change while running.
+  u32 stateSize() {
+    auto s = StateSerializer::measure();
+    serializeState(s);
+    return s.offset();
+  }
+
+  // snapshot of the whole machine, call it from the emulation thread or while it is paused.
+  // return the bytes written, 0 if `out` is too small.
+  u32 saveState(std::span<u8> out) {
+    auto s = StateSerializer::save(out);
+    serializeState(s);
+    return s.ok() ? s.offset() : 0;
+  }
+
+  // the machine is left untouched if the state is not a state of this game and version.
+  bool loadState(std::span<const u8> in) {
+    if (in.size() != stateSize()) {
+      GB_LOG(WARN) << "invalid save state size " << in.size();
+      return false;
+    }
+    auto s = StateSerializer::load(in);
+    u8 magic[sizeof(STATE_MAGIC)]{};
+    u16 version{};
+    u16 checksum{};
+    s(magic, version, checksum);
+    if (memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0 || version != STATE_VERSION ||
+        checksum != cartridge_->header().globalChecksum()) {
+      GB_LOG(WARN) << "save state version " << version << " does not match this game or build";
+      return false;
+    }
+    serializeComponents(s);
+    // the next input frame starts here.
+    next_input_cycle_ = 0;
+    // the periodic tasks follow the bus clock of the state, as in the machine which saved it.
+    rtc_.scheduler().rebase(memory_bus_.cycles());
+    return s.ok();
+  }
+
+  enum class MovieMode : u8 {
+    kNONE,
+    kRECORD,
+    kPLAY,
+  };
+
+  // live input (see Joypad::Button). the emulation thread applies it at the start of every input
+  // frame (Movie), never in the middle of one, so a run depends only on its initial state and masks.
+  void press(u8 buttons, bool pressed) {
+    if (pressed) {
+      input_ |= buttons;
+    } else {
+      input_ &= ~buttons;
+    }
+  }
+
+  // replace the whole live input mask.
+  void input(u8 buttons) { input_ = buttons; }
+
+  // run `task` on the emulation thread at the next input frame.
+  void post(std::function<void()> task) {
+    std::lock_guard lock(posted_mutex_);
+    posted_.push_back(std::move(task));
+  }
+
+  // movie control, call it from the emulation thread (see post()) or while it is stopped.
+  // the recording starts from the current state.
+  void recordMovie() {
+    stopMovie();
+    movie_.rom_hash = cartridge_->romImage()->hash();
+    movie_.initial_state.resize(stateSize());
+    saveState(movie_.initial_state);
+    movie_.frames.clear();
+    movie_mode_ = MovieMode::kRECORD;
+    // the first mask is applied right away, as it is when the movie is played.
+    next_input_cycle_ = 0;
+  }
+
+  // stop recording or playing, return the movie.
+  Movie stopMovie() {
+    if (movie_mode_ == MovieMode::kPLAY) {
+      rtc_.speed(movie_speed_);
+    }
+    movie_mode_ = MovieMode::kNONE;
+    return std::move(movie_);
+  }
+
+  // restore the initial state and replay the masks at unlimited speed,
+  // live input is ignored until the end of the movie.
+  bool playMovie(Movie movie) {
+    stopMovie();
+    if (movie.rom_hash != cartridge_->romImage()->hash()) {
+      GB_LOG(WARN) << "the movie was not recorded with this game";
+      return false;
+    }
+    if (!loadState(movie.initial_state)) {
+      return false;
+    }
+    movie_       = std::move(movie);
+    movie_frame_ = 0;
+    movie_speed_ = rtc_.speed();
+    rtc_.speed(RTC::UNLIMITED_SPEED);
+    movie_mode_ = MovieMode::kPLAY;
+    return true;
+  }
+
+  MovieMode movieMode() const { return movie_mode_; }
+
+  // go back `frames` frames (as far as the history goes), applied by the emulation thread
+  // at the next frame boundary. frames after the last snapshot are emulated again, muted.
+  // ignored while a movie is recorded or played.
+  void rewind(u32 frames) { rewind_request_ += frames; }
+
+  const RewindBuffer& rewindBuffer() const { return rewind_buffer_; }
+
+  Cartridge* cartridge_{};
+  RTC rtc_;
+  Timer timer_;
+  CPU cpu_;
+  Serial serial_;
+  MemoryBus memory_bus_;
+  PPU ppu_;
+  Joypad joypad_;
+  APU apu_;
+  MiniAudioWrapper miniaudio_wrapper;
+
+private:
+  GameBoy(Cartridge* cartridge, const GameBoyOptions& options)
+      : cartridge_(cartridge),
+        miniaudio_wrapper(this),
+        rewind_buffer_(options.rewind_budget, REWIND_KEYFRAME) {
+    GB_TRACE_CLOCK(&memory_bus_);
     memory_bus_.timer_     = &timer_;
     memory_bus_.cartridge_ = cartridge_;
     memory_bus_.ppu_       = &ppu_;
     memory_bus_.serial_    = &serial_;
     memory_bus_.joypad_    = &joypad_;
     memory_bus_.apu_       = &apu_;
+    cartridge_->clockSource(&memory_bus_);
     cpu_.memoryBus(&memory_bus_);
     ppu_.memoryBus(&memory_bus_);
     timer_.memoryBus(&memory_bus_);
     serial_.memoryBus(&memory_bus_);
     joypad_.memoryBus(&memory_bus_);
-    rtc_.addTask([this]() { return cpu_.update(); });
+    rtc_.cpuTask([this](u64 budget) { return run(budget); });
+    // the kernel writes the mapped save RAM back by itself, this only bounds the loss on a crash.
+    rtc_.scheduler().addPeriodicTask(SAVE_FLUSH_PERIOD, Scheduler::Priority::kLOW,
+                                     [this] { cartridge_->flush(false); });
+    if (options.rewind_budget > 0) {
+      rtc_.scheduler().addPeriodicTask(RTC::CYCLES_PER_FRAME, Scheduler::Priority::kHIGH,
+                                       [this] { rewindFrame(); });
+    }
+    rtc_.speedObserver([this](f32 speed) {
+      // keep the rendered frame rate close to the host refresh rate.
+      ppu_.frameSkip(speed == RTC::UNLIMITED_SPEED ? MAX_FRAME_SKIP : std::ceil(speed));
+      playback_speed_ = speed;
+      apu_.playbackSpeed(playback_speed_);
+    });
 
     cpu_.reset();
     memory_bus_.reset();
 
-    miniaudio_wrapper.init();
+    if (options.audio) {
+      miniaudio_wrapper.init();
+    } else {
+      // nobody listens, skip the mixing.
+      playback_speed_ = RTC::UNLIMITED_SPEED;
+      apu_.playbackSpeed(playback_speed_);
+    }
   }
 
-  Cartridge* cartridge_{};
-  RTC rtc_;
-  Timer timer_;
-  CPU cpu_;
-  Serial serial_;
-  MemoryBus memory_bus_;
-  PPU ppu_;
-  Joypad joypad_;
-  APU apu_;
-  MiniAudioWrapper miniaudio_wrapper;
+  void serializeState(StateSerializer& s) {
+    u8 magic[sizeof(STATE_MAGIC)]{};
+    memcpy(magic, STATE_MAGIC, sizeof(magic));
+    u16 version  = STATE_VERSION;
+    u16 checksum = cartridge_->header().globalChecksum();
+    s(magic, version, checksum);
+    serializeComponents(s);
+  }
+
+  void serializeComponents(StateSerializer& s) {
+    s(cpu_, memory_bus_, timer_, serial_, joypad_, ppu_, apu_, *cartridge_);
+  }
+
+  u64 run(u64 budget) {
+    GB_TRACE_CLOCK(&memory_bus_);
+    u64 t_cycle = 0;
+    while (t_cycle < budget) {
+      if (memory_bus_.cycles() >= next_input_cycle_) [[unlikely]] {
+        inputFrame();
+      }
+      t_cycle += cpu_.update();
+    }
+    return t_cycle;
+  }
+
+  // input frames follow the bus clock, which is part of the state, so they start at the same
+  // instruction when a movie is played.
+  void inputFrame() {
+    std::vector<std::function<void()>> tasks;
+    {
+      std::lock_guard lock(posted_mutex_);
+      tasks.swap(posted_);
+    }
+    for (auto& task : tasks) {
+      task();
+    }
+
+    u8 buttons = input_;
+    if (movie_mode_ == MovieMode::kPLAY) {
+      if (movie_frame_ < movie_.frames.size()) {
+        buttons = movie_.frames[movie_frame_++];
+      } else {
+        GB_LOG(INFO) << "movie finished after " << movie_frame_ << " frames";
+        stopMovie();
+      }
+    } else if (movie_mode_ == MovieMode::kRECORD) {
+      movie_.frames.push_back(buttons);
+    }
+    joypad_.buttons(buttons);
+    next_input_cycle_ = (memory_bus_.cycles() / RTC::CYCLES_PER_FRAME + 1) * RTC::CYCLES_PER_FRAME;
+  }
+
+  void rewindFrame() {
+    frames_since_snapshot_++;
+    if (u32 frames = rewind_request_.exchange(0)) {
+      seekBack(frames);
+      return;
+    }
+    if (frames_since_snapshot_ < REWIND_INTERVAL) {
+      return;
+    }
+    frames_since_snapshot_ = 0;
+    rewind_state_.resize(stateSize());
+    saveState(rewind_state_);
+    rewind_buffer_.push(rewind_state_);
+  }
+
+  void seekBack(u32 frames) {
+    if (movie_mode_ != MovieMode::kNONE) {
+      // the replay would append to the recorded frames, or consume the played ones.
+      GB_LOG(WARN) << "cannot rewind while a movie is recorded or played";
+      return;
+    }
+    if (rewind_buffer_.empty()) {
+      return;
+    }
+    // the newest snapshot at or before the target.
+    u32 back = frames <= frames_since_snapshot_
+                       ? 0
+                       : (frames - frames_since_snapshot_ + REWIND_INTERVAL - 1) / REWIND_INTERVAL;
+    back     = std::min(back, rewind_buffer_.size() - 1);
+    u32 skip = frames_since_snapshot_ + back * REWIND_INTERVAL;
+    if (!rewind_buffer_.seek(back, rewind_state_) || !loadState(rewind_state_)) {
+      return;
+    }
+
+    // replay the frames between the snapshot and the target, not paced and not heard.
+    u64 replay             = skip > frames ? (u64) (skip - frames) * RTC::CYCLES_PER_FRAME : 0;
+    frames_since_snapshot_ = replay / RTC::CYCLES_PER_FRAME;
+    apu_.playbackSpeed(RTC::UNLIMITED_SPEED);
+    run(replay);
+    apu_.playbackSpeed(playback_speed_);
+    // the replay moved the bus past the clock loadState() rebased on.
+    rtc_.scheduler().rebase(memory_bus_.cycles());
+  }
+
+  f32 playback_speed_{1.f};
+  RewindBuffer rewind_buffer_;
+  std::atomic<u32> rewind_request_{};
+  u32 frames_since_snapshot_{};
+  std::vector<u8> rewind_state_;
+
+  std::atomic<u8> input_{};
+  u64 next_input_cycle_{};
+  std::mutex posted_mutex_;
+  std::vector<std::function<void()>> posted_;
+  std::atomic<MovieMode> movie_mode_{MovieMode::kNONE};
+  Movie movie_;
+  u32 movie_frame_{};
+  f32 movie_speed_{1.f};
 };
 
 
@@ -1,6 +1,9 @@
 #include "include/gameboy_c.h"
 
+#include "common/profiler.h"
+#include "common/trace.h"
 #include "gameboy.h"
+#include "vec_env.h"
 
 #define CHECK_GB(GB)      \
   if (!GB) [[unlikely]] { \
@@ -40,3 +43,194 @@ extern "C" const char *GameBoyTextureBuffer(GameBoy gb) {
   auto *gameboy = (gb::GameBoy *) gb;
   return (char *) gameboy->ppu_.lcdData().get();
 }
+
+extern "C" void GameBoyAPURecordStart(GameBoy gb) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->apu_.recorder().start(gameboy->apu_.cycles());
+}
+
+extern "C" int GameBoyAPURecordStop(GameBoy gb, const char *prefix) {
+  if (!gb || !prefix) [[unlikely]] {
+    return 0;
+  }
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->apu_.recorder().stop();
+  return gameboy->apu_.recorder().save(prefix);
+}
+
+extern "C" void GameBoySpeed(GameBoy gb, float speed) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->rtc_.speed(speed);
+}
+
+extern "C" void GameBoyTurbo(GameBoy gb, int enable) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->rtc_.turbo(enable);
+}
+
+extern "C" void GameBoyRumble(GameBoy gb, GameBoyRumbleCallback callback, void *user_data) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  if (!callback) {
+    gameboy->cartridge_->rumbleCallback(nullptr);
+    return;
+  }
+  gameboy->cartridge_->rumbleCallback([callback, user_data](bool on) { callback(user_data, on); });
+}
+
+extern "C" unsigned GameBoyStateSize(GameBoy gb) {
+  if (!gb) [[unlikely]] {
+    return 0;
+  }
+  return ((gb::GameBoy *) gb)->stateSize();
+}
+
+extern "C" unsigned GameBoySaveState(GameBoy gb, void *buffer, unsigned size) {
+  if (!gb || !buffer) [[unlikely]] {
+    return 0;
+  }
+  return ((gb::GameBoy *) gb)->saveState({(gb::u8 *) buffer, size});
+}
+
+extern "C" int GameBoyLoadState(GameBoy gb, const void *buffer, unsigned size) {
+  if (!gb || !buffer) [[unlikely]] {
+    return 0;
+  }
+  return ((gb::GameBoy *) gb)->loadState({(const gb::u8 *) buffer, size});
+}
+
+extern "C" void GameBoyRewind(GameBoy gb, unsigned frames) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->rewind(frames);
+}
+
+extern "C" void GameBoyPress(GameBoy gb, unsigned buttons, int pressed) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->press(buttons, pressed);
+}
+
+extern "C" void GameBoyMovieRecord(GameBoy gb) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->post([gameboy] { gameboy->recordMovie(); });
+}
+
+extern "C" void GameBoyMovieStop(GameBoy gb, const char *path) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->post([gameboy, path = std::string(path ? path : "")] {
+    bool recording = gameboy->movieMode() == gb::GameBoy::MovieMode::kRECORD;
+    auto movie     = gameboy->stopMovie();
+    if (recording && !path.empty()) {
+      movie.save(path);
+    }
+  });
+}
+
+extern "C" void GameBoyMoviePlay(GameBoy gb, const char *path) {
+  CHECK_GB(gb)
+  if (!path) [[unlikely]] {
+    return;
+  }
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->post([gameboy, path = std::string(path)] {
+    gb::Movie movie;
+    if (movie.load(path)) {
+      gameboy->playMovie(std::move(movie));
+    }
+  });
+}
+
+extern "C" GameBoy GameBoyFork(GameBoy gb) {
+  if (!gb) [[unlikely]] {
+    return nullptr;
+  }
+  return ((gb::GameBoy *) gb)->fork().release();
+}
+
+extern "C" GameBoyVecEnv GameBoyVecEnvCreate(const char *game_path, unsigned size, unsigned threads) {
+  if (!game_path) [[unlikely]] {
+    return nullptr;
+  }
+  return new gb::VecEnv(game_path, size, threads ? threads : std::thread::hardware_concurrency());
+}
+
+extern "C" void GameBoyVecEnvDestroy(GameBoyVecEnv env) { delete (gb::VecEnv *) env; }
+
+extern "C" void GameBoyVecEnvReset(GameBoyVecEnv env) {
+  CHECK_GB(env)
+  ((gb::VecEnv *) env)->reset();
+}
+
+extern "C" void GameBoyVecEnvStep(GameBoyVecEnv env, const unsigned char *actions) {
+  if (!env || !actions) [[unlikely]] {
+    return;
+  }
+  auto *vec_env = (gb::VecEnv *) env;
+  vec_env->step({actions, vec_env->size()});
+}
+
+extern "C" const unsigned char *GameBoyVecEnvObservations(GameBoyVecEnv env) {
+  if (!env) [[unlikely]] {
+    return nullptr;
+  }
+  return ((gb::VecEnv *) env)->observations().data();
+}
+
+extern "C" int GameBoyProfileEnabled(void) {
+#ifdef GB_PROFILE
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+extern "C" void GameBoyProfileReset(void) { gb::Profile::resetAll(); }
+
+extern "C" const char *GameBoyProfileReport(void) {
+  static std::string report;
+  report = gb::Profile::report();
+  return report.c_str();
+}
+
+extern "C" int GameBoyTraceEnabled(void) {
+#ifdef GB_TRACE
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+extern "C" int GameBoyTraceWrite(const char *path) {
+  if (!path) [[unlikely]] {
+    return 0;
+  }
+  return gb::Trace::writeChromeJson(path);
+}
+
+extern "C" void GameBoyGuestProfileStart(GameBoy gb) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->post([gameboy] {
+    auto &profiler = gameboy->cpu_.guestProfiler();
+    profiler.disable();
+    profiler.enable();
+  });
+}
+
+extern "C" void GameBoyGuestProfileStop(GameBoy gb, const char *path) {
+  CHECK_GB(gb)
+  auto *gameboy = (gb::GameBoy *) gb;
+  gameboy->post([gameboy, path = std::string(path ? path : "")] {
+    auto &profiler = gameboy->cpu_.guestProfiler();
+    profiler.disable();
+    if (!path.empty()) {
+      profiler.writeFoldedStacks(path);
+    }
+  });
+}
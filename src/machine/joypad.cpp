@@ -23,4 +23,14 @@ DEF_KEY(Left, direction, 1)
 DEF_KEY(Up, direction, 2)
 DEF_KEY(Down, direction, 3)
 
+void Joypad::buttons(u8 mask) {
+  u8 select    = (~mask & 0xf) | 0xf0;
+  u8 direction = (~mask >> 4) | 0xf0;
+  if ((select_ & ~select) | (direction_ & ~direction)) {
+    memory_bus_->if_.irq(InterruptType::kJOYPAD);
+  }
+  select_    = select;
+  direction_ = direction;
+}
+
 } // namespace gb
@@ -7,8 +7,25 @@ class MemoryBus;
 
 class Joypad : public Memory<0xff00, 0xff00> {
 public:
+  // bits of a button mask, 1 = pressed.
+  enum Button : u8 {
+    kA      = 1 << 0,
+    kB      = 1 << 1,
+    kSELECT = 1 << 2,
+    kSTART  = 1 << 3,
+    kRIGHT  = 1 << 4,
+    kLEFT   = 1 << 5,
+    kUP     = 1 << 6,
+    kDOWN   = 1 << 7,
+  };
+
   Joypad() { ram_[0] = 0xff; }
 
+  // set every button at once, a newly pressed button requests the joypad interrupt.
+  void buttons(u8 mask);
+
+  u8 buttons() const { return (~select_ & 0xf) | ((~direction_ & 0xf) << 4); }
+
 #define DECL_KEY(NAME, TYPE, REG_BIT) void NAME(bool press);
 
   DECL_KEY(A, select, 0)
@@ -39,6 +56,11 @@ public:
 
   void memoryBus(MemoryBus* memory_bus) { memory_bus_ = memory_bus; }
 
+  void serialize(StateSerializer& s) {
+    Memory::serialize(s);
+    s(select_, direction_);
+  }
+
 private:
   void reset() {
     u8 v = ram_[0];
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/state_serializer.h"
 #include "common/type.h"
 #include "common/utils.h"
 
@@ -24,6 +25,8 @@ public:
     ram_[addr - LO] = val;
   }
 
+  void serialize(StateSerializer &s) { s(ram_); }
+
 protected:
   u8 ram_[HI - LO + 1]{};
 };
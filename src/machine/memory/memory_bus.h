@@ -1,5 +1,6 @@
 #include "cartridge/cartridge.h"
 #include "common/logger.h"
+#include "common/profiler.h"
 #include "machine/apu/apu.h"
 #include "machine/cpu/interrupt.h"
 #include "machine/cpu/timer.h"
@@ -13,7 +14,7 @@ namespace gb {
 
 // https://gbdev.io/pandocs/Memory_Map.html
 
-class MemoryBus : public MemoryAccessor {
+class MemoryBus : public MemoryAccessor, public ClockSource {
   class InvalidMemory : public Memory<0, 0> {
   public:
     u8 get(u16 addr) const override { return 0xff; }
@@ -68,6 +69,7 @@ public:
   }
 
   u8 get(u16 addr) const override {
+    GB_PROFILE_ZONE_SCOPE(profileZone(addr));
 #ifndef NDEBUG
     if (accessType(addr) == AccessType::kW) [[unlikely]] {
       return 0xff;
@@ -77,6 +79,7 @@ public:
   }
 
   void set(u16 addr, u8 val) override {
+    GB_PROFILE_ZONE_SCOPE(profileZone(addr));
 #ifndef NDEBUG
     if (accessType(addr) == AccessType::kR) [[unlikely]] {
       return;
@@ -87,7 +90,14 @@ public:
 
   INLINE void setWithoutCheck(u16 addr, u8 val) { getMemory(addr)->set(addr, val); }
 
-  void tick() const {
+  // T-cycles elapsed since power on.
+  u64 cycles() const override { return t_cycles_; }
+
+  // RAM regions and interrupt registers, the devices on the bus serialize themselves.
+  void serialize(StateSerializer &s) { s(wram_, vram_, hram_, if_, ie_, speed_switch_, t_cycles_); }
+
+  void tick() {
+    t_cycles_ += 4;
     for (u8 i = 0; i < 4; i++) {
       timer_->tick();
       serial_->tick();
@@ -185,6 +195,28 @@ private:
     GB_UNREACHABLE()
   }
 
+  // the regions of getMemory, IO includes IE.
+  static ProfileZone profileZone(u16 addr) {
+    switch (addr) {
+      case 0x0000 ... 0x7FFF:
+        return ProfileZone::kBUS_ROM;
+      case 0x8000 ... 0x9FFF:
+        return ProfileZone::kBUS_VRAM;
+      case 0xA000 ... 0xBFFF:
+        return ProfileZone::kBUS_EXTERNAL_RAM;
+      case 0xC000 ... 0xFDFF:
+        return ProfileZone::kBUS_WRAM;
+      case 0xFE00 ... 0xFE9F:
+        return ProfileZone::kBUS_OAM;
+      case 0xFEA0 ... 0xFEFF:
+        return ProfileZone::kBUS_UNUSABLE;
+      case 0xFF80 ... 0xFFFE:
+        return ProfileZone::kBUS_HRAM;
+      default:
+        return ProfileZone::kBUS_IO;
+    }
+  }
+
   static inline AccessType accessType(u16 addr) {
     static const std::unordered_map<u16, AccessType> m{
             {0xFF00, AccessType::kMIXED}, {0xFF01, AccessType::kRW},    {0xFF02, AccessType::kRW},
@@ -229,6 +261,9 @@ public:
   mutable Memory<0xff80, 0xfffe> hram_{};
   mutable InterruptEnable ie_;
   mutable InvalidMemory invalid_memory_;
+
+private:
+  u64 t_cycles_{};
 };
 
 } // namespace gb
@@ -43,6 +43,8 @@ public:
     }
   }
 
+  void serialize(StateSerializer &s) { s(ram_, wram_idx_); }
+
 private:
   u8 ram_[0x8000]{};
   Memory<0xff70, 0xff70> wram_idx_{};
@@ -0,0 +1,78 @@
+#include "movie.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "common/logger.h"
+
+namespace gb {
+
+void Movie::serialize(StateSerializer &s) {
+  u8 magic[sizeof(MAGIC)]{};
+  memcpy(magic, MAGIC, sizeof(magic));
+  u16 version = VERSION;
+  s(magic, version);
+  if (s.loading() && (memcmp(magic, MAGIC, sizeof(magic)) != 0 || version != VERSION)) {
+    s.fail();
+    return;
+  }
+
+  u32 state_size = initial_state.size();
+  s(rom_hash, state_size);
+  if (s.loading()) {
+    if (state_size > s.remaining()) {
+      s.fail();
+      return;
+    }
+    initial_state.resize(state_size);
+  }
+  s.bytes(initial_state.data(), state_size);
+
+  u32 frame_count = frames.size();
+  s(frame_count);
+  if (s.loading()) {
+    if (frame_count > s.remaining()) {
+      s.fail();
+      return;
+    }
+    frames.resize(frame_count);
+  }
+  s.bytes(frames.data(), frame_count);
+}
+
+bool Movie::save(const std::string &path) {
+  auto measure = StateSerializer::measure();
+  serialize(measure);
+  std::vector<u8> data(measure.offset());
+  auto s = StateSerializer::save(data);
+  serialize(s);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(reinterpret_cast<const char *>(data.data()), data.size())) {
+    GB_LOG(WARN) << "can not write movie " << path;
+    return false;
+  }
+  return true;
+}
+
+bool Movie::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<u8> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  if (!file.is_open()) {
+    GB_LOG(WARN) << "can not read movie " << path;
+    return false;
+  }
+
+  Movie movie;
+  auto s = StateSerializer::load(data);
+  movie.serialize(s);
+  if (!s.ok() || s.offset() != data.size()) {
+    GB_LOG(WARN) << path << " is not a movie of version " << VERSION;
+    return false;
+  }
+  *this = std::move(movie);
+  return true;
+}
+
+} // namespace gb
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/state_serializer.h"
+#include "common/type.h"
+
+namespace gb {
+
+// Input recording which replays a run exactly: the state the recording started from
+// and the button mask (see Joypad::Button) of every input frame after it.
+// An input frame is RTC::CYCLES_PER_FRAME T-cycles of the memory bus clock.
+//
+// file: "GBMV" | u16 version | u64 ROM hash | u32 state size | state
+//       | u32 frame count | one mask per frame, every value little endian.
+struct Movie {
+  static constexpr u8 MAGIC[]  = {'G', 'B', 'M', 'V'};
+  static constexpr u16 VERSION = 1;
+
+  u64 rom_hash{};
+  std::vector<u8> initial_state;
+  std::vector<u8> frames;
+
+  bool save(const std::string &path);
+
+  // false if the file can not be read or is not a movie of this version.
+  bool load(const std::string &path);
+
+  void serialize(StateSerializer &s);
+};
+
+} // namespace gb
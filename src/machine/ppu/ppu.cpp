@@ -23,8 +23,14 @@ void PPU::dmaUpdate() {
     return;
   }
 
+  u16 dma_base = memory_bus_->get(DMA_BASE) * 0x100;
+  if (dma_offset_ == 0) {
+    if (dma_restarting_) {
+      GB_TRACE_END(kDMA);
+    }
+    GB_TRACE_BEGIN(kDMA, "oam dma", dma_base);
+  }
   dma_restarting_ = false;
-  u16 dma_base    = memory_bus_->get(DMA_BASE) * 0x100;
   u16 offset      = dma_base + dma_offset_;
 
   if (offset > ECHO_RAM_BASE) {
@@ -40,9 +46,17 @@ void PPU::dmaUpdate() {
     dma_enable_ = false;
     dma_timer_  = 0;
     dma_offset_ = 0;
+    GB_TRACE_END(kDMA);
   }
 }
 
+void PPU::mode(PPURegister::PPUMode mode) {
+  [[maybe_unused]] static constexpr const char *NAMES[] = {"hblank", "vblank", "oam scan", "drawing"};
+  GB_TRACE_END(kPPU_MODE);
+  GB_TRACE_BEGIN(kPPU_MODE, NAMES[static_cast<u8>(mode)], ppu_reg_.LY());
+  ppu_reg_.mode(mode);
+}
+
 void PPU::increaseLY() {
   ppu_reg_.LY(ppu_reg_.LY() + 1);
   if (windowEnable() && windowVisible() //
@@ -62,10 +76,13 @@ void PPU::horizontalBlank() {
 
     if (ppu_reg_.LY() == LCD_HEIGHT) {
       memory_bus_->if_.irq(InterruptType::kVBLANK);
-      ppu_reg_.mode(PPURegister::PPUMode::kVERTICAL_BLANK);
-      lcd_data_.switchBuffer();
+      mode(PPURegister::PPUMode::kVERTICAL_BLANK);
+      if (!skip_frame_) {
+        lcd_data_.switchBuffer();
+      }
+      skip_frame_ = ++frame_count_ % frame_skip_ != 0;
     } else {
-      ppu_reg_.mode(PPURegister::PPUMode::kOAM_SCAN);
+      mode(PPURegister::PPUMode::kOAM_SCAN);
     }
   }
 }
@@ -75,7 +92,9 @@ void PPU::verticalBlank() {
     dots_ = 0;
     increaseLY();
     if (ppu_reg_.LY() == 154) {
-      ppu_reg_.mode(PPURegister::PPUMode::kOAM_SCAN);
+      GB_TRACE_END(kFRAME);
+      GB_TRACE_BEGIN(kFRAME, "frame", frame_count_);
+      mode(PPURegister::PPUMode::kOAM_SCAN);
       ppu_reg_.LY(0);
       fetcher_window_line_ = 0;
     }
@@ -85,16 +104,16 @@ void PPU::verticalBlank() {
 void PPU::oamScan() {
   if (dots_ == 80) {
     dots_ = 0;
-    ppu_reg_.mode(PPURegister::PPUMode::kDRAWING_PIXELS);
+    mode(PPURegister::PPUMode::kDRAWING_PIXELS);
   }
 }
 
 void PPU::drawingPixels() {
   if (dots_ == 172) {
     dots_ = 0;
-    ppu_reg_.mode(PPURegister::PPUMode::kHORIZONTAL_BLANK);
+    mode(PPURegister::PPUMode::kHORIZONTAL_BLANK);
 
-    if (ppu_reg_.LY() > LCD_HEIGHT) {
+    if (ppu_reg_.LY() > LCD_HEIGHT || skip_frame_) {
       return;
     }
 
@@ -141,26 +160,31 @@ inline u8 applyPalette(u8 color, u8 palette) {
   return color;
 }
 
-void setPixel(u8 *buffer, i32 x, i32 y, u8 r, u8 g, u8 b) {
-  i32 offset         = (y * LCD_WIDTH + x) * 4;
-  buffer[offset]     = r;
-  buffer[offset + 1] = g;
-  buffer[offset + 2] = b;
-  buffer[offset + 3] = 0xff;
+void PPU::putPixel(u8 x, u8 shade) {
+  // sprites may hang over the right edge.
+  if (x >= LCD_WIDTH) {
+    return;
+  }
+  u32 offset = ppu_reg_.LY() * LCD_WIDTH + x;
+  u32 color  = dmg_palette_[shade];
+  u8 *pixel  = lcd_data_.get() + offset * 4;
+  pixel[0]   = getColor(color, ColorType::kRED);
+  pixel[1]   = getColor(color, ColorType::kGREEN);
+  pixel[2]   = getColor(color, ColorType::kBLUE);
+  pixel[3]   = 0xff;
+  if (shade_buffer_) {
+    shade_buffer_[offset] = shade;
+  }
 }
 
 void PPU::mixPixel() {
-  u8 *buffer = lcd_data_.get();
-  u8 x       = fetcher_x_;
-  u8 y       = ppu_reg_.LY();
+  u8 x = fetcher_x_;
 
   u8 bg_color{};
   u8 win_color{};
 
   bg_color = applyPalette(background_pixel_.color, background_pixel_.palette);
-  setPixel(buffer, x, y, getColor(dmg_palette_[bg_color], ColorType::kRED),
-           getColor(dmg_palette_[bg_color], ColorType::kGREEN),
-           getColor(dmg_palette_[bg_color], ColorType::kBLUE));
+  putPixel(x, bg_color);
   scanline_rendered_[x] = bg_color != 0;
 
   if (fetcher_x_ >= ppu_reg_.WX() - 7   //
@@ -168,10 +192,7 @@ void PPU::mixPixel() {
       && ppu_reg_.WY() <= ppu_reg_.LY() //
       && ppu_reg_.WX() <= 166) {
     win_color = applyPalette(window_pixel_.color, window_pixel_.palette);
-    if (win_color)
-      setPixel(buffer, x, y, getColor(dmg_palette_[win_color], ColorType::kRED),
-               getColor(dmg_palette_[win_color], ColorType::kGREEN),
-               getColor(dmg_palette_[win_color], ColorType::kBLUE));
+    if (win_color) putPixel(x, win_color);
     scanline_rendered_[x] = win_color != 0;
   }
 }
@@ -285,10 +306,7 @@ void PPU::fetchAndDrawSpriteTileData() {
 
       u8 sprite_color           = applyPalette(sprite_pixel_.color, sprite_pixel_.palette);
       if (sprite_color) {
-        setPixel(lcd_data_.get(), pixel_x, ppu_reg_.LY(),
-                 getColor(dmg_palette_[sprite_color], ColorType::kRED),
-                 getColor(dmg_palette_[sprite_color], ColorType::kGREEN),
-                 getColor(dmg_palette_[sprite_color], ColorType::kBLUE));
+        putPixel(pixel_x, sprite_color);
       }
     }
 
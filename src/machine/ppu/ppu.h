@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <queue>
 
 #include "common/defs.h"
 #include "common/logger.h"
+#include "common/profiler.h"
+#include "common/trace.h"
 #include "common/type.h"
 #include "machine/memory/memory_accessor.h"
 #include "object_attribute.h"
@@ -82,12 +85,15 @@ public:
   }
 
   void tick() {
+    GB_PROFILE_SCOPE(kPPU);
     dmaUpdate();
     if (!getBitN(ppu_reg_.LCDC(), 7)) {
       GB_LOG(DEBUG) << "LCD/PPU is off";
       return;
     }
     dots_++;
+    GB_PROFILE_ZONE_SCOPE(static_cast<ProfileZone>(static_cast<u8>(ProfileZone::kPPU_HORIZONTAL_BLANK)
+                                                   + static_cast<u8>(ppu_reg_.mode())));
     switch (ppu_reg_.mode()) {
       case PPURegister::PPUMode::kHORIZONTAL_BLANK:
         horizontalBlank();
@@ -110,6 +116,23 @@ public:
 
   void setPalette(Palette palette) { dmg_palette_ = palettes_[static_cast<u8>(palette)]; }
 
+  // render one frame out of `n`, the skipped frames are still emulated
+  // but the pixel pipeline is bypassed and the LCD keeps the last rendered frame.
+  void frameSkip(u8 n) { frame_skip_ = std::max<u8>(n, 1); }
+
+  u64 frameCount() const { return frame_count_; }
+
+  // also write the shade (0-3, after the palette registers) of every pixel to `plane`,
+  // LCD_WIDTH x LCD_HEIGHT row major, nullptr to stop. the plane is not double buffered,
+  // read it during the vertical blank.
+  void shadeBuffer(u8 *plane) { shade_buffer_ = plane; }
+
+  // the LCD buffers are output only, the next frame redraws them.
+  void serialize(StateSerializer &s) {
+    s(ppu_reg_, oam_, fetcher_window_line_, dma_enable_, dma_restarting_, dma_offset_, dma_timer_, dots_,
+      frame_count_);
+  }
+
   void memoryBus(MemoryBus *memory_bus) {
     memory_bus_ = memory_bus;
     ppu_reg_.memoryBus(memory_bus);
@@ -120,6 +143,9 @@ private:
 
   bool dmaRunning() const { return dma_timer_ > 4 || dma_restarting_; }
 
+  // enter `mode`, traced as a span of the PPU mode track.
+  void mode(PPURegister::PPUMode mode);
+
   void horizontalBlank();
   void verticalBlank();
   void oamScan();
@@ -147,6 +173,7 @@ private:
   void fetchSprite();
   void fetchAndDrawSpriteTileData();
   void mixPixel();
+  void putPixel(u8 x, u8 shade);
 
   void increaseLY();
 
@@ -163,6 +190,10 @@ private:
   u8 scanline_rendered_[LCD_WIDTH]{};
   std::priority_queue<ObjectAttribute> sprite_buffer_;
   u16 dots_{};
+  u64 frame_count_{};
+  u8 frame_skip_{1};
+  bool skip_frame_{};
+  u8 *shade_buffer_{};
 
 #define DEF(NAME, C0, C1, C2, C3) static constexpr const u32 NAME##_palette_[] = {C0, C1, C2, C3};
 #include "palette.h"
@@ -0,0 +1,125 @@
+#include "rewind_buffer.h"
+
+#include <algorithm>
+
+#include "common/utils.h"
+
+namespace gb {
+
+namespace {
+void putVarint(std::vector<u8> &out, u32 value) {
+  while (value >= 0x80) {
+    out.push_back((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(value);
+}
+
+u32 getVarint(std::span<const u8> in, u32 &pos) {
+  u32 value = 0;
+  for (u32 shift = 0; pos < in.size(); shift += 7) {
+    u8 byte = in[pos++];
+    value |= (byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      break;
+    }
+  }
+  return value;
+}
+} // namespace
+
+void RewindBuffer::encode(std::span<const u8> a, std::span<const u8> b, std::vector<u8> &out) {
+  auto x = [&](u32 i) -> u8 { return b.empty() ? a[i] : a[i] ^ b[i]; };
+  auto zeroRun = [&](u32 i) {
+    // a literal run is only broken by at least 3 zeros, a shorter run costs more than it saves.
+    return x(i) == 0 && (i + 1 >= a.size() || x(i + 1) == 0) && (i + 2 >= a.size() || x(i + 2) == 0);
+  };
+
+  out.clear();
+  u32 n = a.size();
+  for (u32 i = 0; i < n;) {
+    u32 begin = i;
+    while (i < n && x(i) == 0) {
+      i++;
+    }
+    putVarint(out, i - begin);
+
+    begin = i;
+    while (i < n && !zeroRun(i)) {
+      i++;
+    }
+    putVarint(out, i - begin);
+    for (u32 j = begin; j < i; j++) {
+      out.push_back(x(j));
+    }
+  }
+}
+
+void RewindBuffer::decode(std::span<const u8> in, std::span<u8> out) {
+  u32 pos = 0;
+  u32 dst = 0;
+  while (pos < in.size()) {
+    dst += getVarint(in, pos);
+    u32 literals = getVarint(in, pos);
+    GB_ASSERT(dst + literals <= out.size() && pos + literals <= in.size());
+    for (u32 i = 0; i < literals; i++) {
+      out[dst++] ^= in[pos++];
+    }
+  }
+}
+
+void RewindBuffer::push(std::span<const u8> state) {
+  GB_ASSERT(newest_.empty() || newest_.size() == state.size());
+  thread_local std::vector<u8> scratch;
+
+  Entry entry;
+  entry.keyframe = entries_.empty() || ++since_keyframe_ >= keyframe_interval_;
+  if (entry.keyframe) {
+    since_keyframe_ = 0;
+  }
+  encode(state, entry.keyframe ? std::span<const u8>{} : std::span<const u8>{newest_}, scratch);
+  // copy out of the scratch buffer, it would keep the capacity of a full state.
+  entry.data.assign(scratch.begin(), scratch.end());
+  bytes_ += entry.data.size();
+  entries_.push_back(std::move(entry));
+  newest_.assign(state.begin(), state.end());
+  evict();
+  size_ = entries_.size();
+}
+
+void RewindBuffer::evict() {
+  while (bytes_ > budget_ && !entries_.empty()) {
+    // a delta is useless without the keyframe before it.
+    do {
+      bytes_ -= entries_.front().data.size();
+      entries_.pop_front();
+    } while (!entries_.empty() && !entries_.front().keyframe);
+  }
+}
+
+bool RewindBuffer::seek(u32 back, std::vector<u8> &out) {
+  if (entries_.empty()) {
+    return false;
+  }
+  u32 target = entries_.size() - 1 - std::min<u32>(back, entries_.size() - 1);
+  u32 key    = target;
+  while (!entries_[key].keyframe) {
+    key--;
+  }
+
+  out.assign(newest_.size(), 0);
+  for (u32 i = key; i <= target; i++) {
+    decode(entries_[i].data, out);
+  }
+
+  while (entries_.size() > target + 1) {
+    bytes_ -= entries_.back().data.size();
+    entries_.pop_back();
+  }
+  size_           = entries_.size();
+  since_keyframe_ = target - key;
+  newest_         = out;
+  return true;
+}
+
+} // namespace gb
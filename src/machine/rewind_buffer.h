@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+// History of save states under a fixed memory budget.
+// Every snapshot is stored as the XOR against the previous one, run length encoded:
+// between two frames most of the state does not change and the delta is mostly zeros.
+// Every `keyframe_interval` snapshots the state itself is stored, a snapshot is rebuilt
+// from the keyframe before it. The oldest keyframe and its deltas are dropped together
+// when the budget is exceeded.
+class RewindBuffer {
+public:
+  RewindBuffer(u64 budget, u32 keyframe_interval) : budget_(budget), keyframe_interval_(keyframe_interval) {}
+
+  // every snapshot must have the same size.
+  void push(std::span<const u8> state);
+
+  // decode the snapshot `back` steps before the newest one (0 is the newest) into `out`,
+  // clamped to the oldest one, and drop every newer snapshot. return false if empty.
+  bool seek(u32 back, std::vector<u8> &out);
+
+  void clear() {
+    entries_.clear();
+    newest_.clear();
+    bytes_ = 0;
+    size_  = 0;
+  }
+
+  // size() and bytes() may be read by the UI while the emulation thread pushes.
+  u32 size() const { return size_.load(std::memory_order_relaxed); }
+
+  bool empty() const { return entries_.empty(); }
+
+  // encoded bytes, what counts against the budget.
+  u64 bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+  u64 budget() const { return budget_; }
+
+  // run length encoding of `a ^ b` (`b` may be empty, then `a` itself):
+  // repeated (varint zero run, varint literal count, literals) until the end of `a`.
+  static void encode(std::span<const u8> a, std::span<const u8> b, std::vector<u8> &out);
+
+  // XOR the decoded bytes into `out`.
+  static void decode(std::span<const u8> in, std::span<u8> out);
+
+private:
+  struct Entry {
+    bool keyframe{};
+    std::vector<u8> data;
+  };
+
+  void evict();
+
+  u64 budget_{};
+  u32 keyframe_interval_{};
+  std::atomic<u64> bytes_{};
+  std::atomic<u32> size_{}; // entries_.size()
+  u32 since_keyframe_{};
+  std::deque<Entry> entries_;
+  std::vector<u8> newest_; // the newest snapshot decoded, the base of the next delta
+};
+
+} // namespace gb
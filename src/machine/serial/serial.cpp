@@ -1,9 +1,11 @@
 #include "serial.h"
 
+#include "common/profiler.h"
 #include "machine/memory/memory_bus.h"
 
 namespace gb {
 void Serial::tick() {
+  GB_PROFILE_SCOPE(kSERIAL);
   if (enable() && count_) {
     SB(SB() << 1 | 1);
     if (--count_ == 0) {
@@ -15,8 +17,8 @@ void Serial::tick() {
         GB_LOG(INFO) << "0x" << std::hex << (u32) buffer_;
       }
 #endif // defined(GB_TEST) || defined(NDEBUG)
-      if (data_ != nullptr) {
-        data_->push(buffer_);
+      if (sink_ != nullptr) {
+        sink_->push(buffer_);
       }
     }
   } else {
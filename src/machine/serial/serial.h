@@ -44,13 +44,19 @@ public:
 
   void memoryBus(MemoryBus* memory_bus) { memory_bus_ = memory_bus; }
 
-  void buffer(SerialBuffer* data) { data_ = data; }
+  // every byte sent goes to `sink`, null for none.
+  void sink(SerialSink* sink) { sink_ = sink; }
+
+  void serialize(StateSerializer& s) {
+    Memory::serialize(s);
+    s(buffer_, count_);
+  }
 
 private:
   MemoryBus* memory_bus_{};
   u8 buffer_{};
   u8 count_{};
-  SerialBuffer* data_{};
+  SerialSink* sink_{};
 };
 
 } // namespace gb
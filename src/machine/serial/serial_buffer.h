@@ -1,36 +1,47 @@
 #pragma once
 
-#include <functional>
 #include <vector>
 
+#include "common/circle_buffer.h"
 #include "common/type.h"
 
 namespace gb {
-class SerialBuffer {
+
+// receives the bytes sent on the serial port, one at a time.
+class SerialSink {
 public:
-  using SerialObserver = std::function<void(const std::vector<u8> &)>;
-  using SerialUpdate   = std::function<void(u8)>;
+  virtual ~SerialSink() = default;
 
-  void push(u8 data) {
-    buffer_.push_back(data);
-    if (observer_) {
-      observer_(buffer_);
-    }
-    if (update_) {
-      update_(data);
-    }
-  }
+  virtual void push(u8 data) = 0;
+};
 
-  void serialObserver(const SerialObserver &observer) { observer_ = observer; }
+// keeps the last `capacity` bytes sent, a ROM printing forever does not grow it.
+class SerialBuffer : public SerialSink {
+public:
+  static constexpr u32 CAPACITY = 64 << 10;
 
-  void serialUpdate(const SerialUpdate &update) { update_ = update; }
+  explicit SerialBuffer(u32 capacity = CAPACITY) : buffer_(capacity) {}
 
-  const std::vector<u8> &buffer() const { return buffer_; }
+  void push(u8 data) override {
+    buffer_.push(data);
+    total_++;
+  }
 
+  // the bytes kept, oldest first.
+  std::vector<u8> bytes() const {
+    std::vector<u8> bytes(buffer_.size());
+    for (u32 i = 0; i < bytes.size(); i++) {
+      bytes[i] = buffer_[i];
+    }
+    return bytes;
+  }
+
+  // every byte sent, including the ones no longer kept.
+  u64 total() const { return total_; }
 
 private:
-  SerialObserver observer_{};
-  SerialUpdate update_{};
-  std::vector<u8> buffer_;
+  CircleBuffer<u8> buffer_;
+  u64 total_{};
 };
+
 } // namespace gb
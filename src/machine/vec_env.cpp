@@ -0,0 +1,73 @@
+#include "vec_env.h"
+
+#include <algorithm>
+
+namespace gb {
+
+VecEnv::VecEnv(const std::string &rom, u32 size, u32 threads) : pool_(threads) {
+  size = std::max(size, 1u);
+  envs_.push_back(std::make_unique<GameBoy>(
+          rom, GameBoyOptions{.audio = false, .battery_save = false, .rewind_budget = 0}));
+  for (u32 i = 1; i < size; i++) {
+    envs_.push_back(envs_[0]->fork());
+  }
+  initial_state_.resize(envs_[0]->stateSize());
+  envs_[0]->saveState(initial_state_);
+
+  observations_.resize(size * OBSERVATION_SIZE);
+  for (auto *reg : {&registers_.af, &registers_.bc, &registers_.de, &registers_.hl, &registers_.pc,
+                    &registers_.sp}) {
+    reg->resize(size);
+  }
+  for (u32 i = 0; i < size; i++) {
+    envs_[i]->ppu_.shadeBuffer(&observations_[i * OBSERVATION_SIZE]);
+  }
+}
+
+void VecEnv::reset() {
+  for (auto &env : envs_) {
+    pool_.submit([&] { env->loadState(initial_state_); });
+  }
+  pool_.wait();
+  // the shade planes are not part of the state, the instances were created before their first
+  // frame was drawn.
+  std::fill(observations_.begin(), observations_.end(), 0);
+  for (u32 i = 0; i < envs_.size(); i++) {
+    mirrorRegisters(i);
+  }
+}
+
+void VecEnv::step(std::span<const u8> actions) {
+  GB_ASSERT(actions.size() == envs_.size());
+  for (u32 i = 0; i < envs_.size(); i++) {
+    pool_.submit([this, i, action = actions[i]] { stepOne(i, action); });
+  }
+  pool_.wait();
+}
+
+void VecEnv::stepOne(u32 i, u8 action) {
+  static constexpr u64 LINE_CYCLES = 456;
+
+  auto &gb = *envs_[i];
+  // take effect now rather than at the next input frame, and stay for the next ones.
+  gb.input(action);
+  gb.joypad_.buttons(action);
+  // stop in the vertical blank, the shade plane holds a whole frame.
+  u64 frame = gb.ppu_.frameCount();
+  for (u64 t_cycle = 0; gb.ppu_.frameCount() == frame && t_cycle < RTC::CYCLES_PER_FRAME;) {
+    t_cycle += gb.rtc_.step(LINE_CYCLES);
+  }
+  mirrorRegisters(i);
+}
+
+void VecEnv::mirrorRegisters(u32 i) {
+  const auto &cpu  = envs_[i]->cpu_;
+  registers_.af[i] = cpu.AF();
+  registers_.bc[i] = cpu.BC();
+  registers_.de[i] = cpu.DE();
+  registers_.hl[i] = cpu.HL();
+  registers_.pc[i] = cpu.PC();
+  registers_.sp[i] = cpu.SP();
+}
+
+} // namespace gb
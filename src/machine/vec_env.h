@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/defs.h"
+#include "common/thread_pool.h"
+#include "common/type.h"
+#include "machine/gameboy.h"
+
+namespace gb {
+
+// N headless instances of one game stepped in lockstep, one frame per step, for
+// reinforcement learning. The observations of all the instances live in a single
+// N x LCD_HEIGHT x LCD_WIDTH tensor of shades (0-3, see PPU::shadeBuffer) written by the
+// PPUs themselves, and the CPU registers are mirrored into one array per register after
+// every step, so a batch is read without copying anything per instance.
+class VecEnv {
+public:
+  static constexpr u32 OBSERVATION_SIZE = LCD_WIDTH * LCD_HEIGHT;
+
+  struct Registers {
+    std::vector<u16> af, bc, de, hl, pc, sp;
+  };
+
+  // every instance is a fork of the first one, they share the ROM mapping.
+  VecEnv(const std::string &rom, u32 size, u32 threads = std::thread::hardware_concurrency());
+
+  u32 size() const { return envs_.size(); }
+
+  // restore every instance to the state it was created in, with a blank observation.
+  void reset();
+
+  // apply one button mask (see Joypad::Button) per instance and run every instance until its
+  // next vertical blank, at most a frame of cycles when the LCD is off.
+  void step(std::span<const u8> actions);
+
+  std::span<const u8> observations() const { return observations_; }
+
+  std::span<const u8> observation(u32 i) const {
+    return {&observations_[i * OBSERVATION_SIZE], OBSERVATION_SIZE};
+  }
+
+  const Registers &registers() const { return registers_; }
+
+  GameBoy &env(u32 i) { return *envs_[i]; }
+
+private:
+  void stepOne(u32 i, u8 action);
+  void mirrorRegisters(u32 i);
+
+  std::vector<std::unique_ptr<GameBoy>> envs_;
+  std::vector<u8> initial_state_;
+  std::vector<u8> observations_;
+  Registers registers_;
+  ThreadPool pool_;
+};
+
+} // namespace gb
@@ -1,6 +1,7 @@
 #include <cstdio>
 
 #include "common/defs.h"
+#include "common/trace.h"
 #include "common/type.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -111,7 +112,9 @@ int main(int argc, char* argv[]) {
     LoadRom(argv[1]);
   }
 
+  GB_TRACE_THREAD("ui");
   RenderLoop = [&]() {
+    GB_TRACE_SCOPE("ui frame");
     glfwPollEvents();
 
     ImGui_ImplOpenGL3_NewFrame();
@@ -122,23 +125,47 @@ int main(int argc, char* argv[]) {
 
     //  Joypad status
     {
-#define DEF_KEY(KEY, ACTION)                           \
-  if (ImGui::IsKeyPressed(ImGuiKey_##KEY)) {           \
-    ((gb::GameBoy*) g_gameboy)->joypad_.ACTION(true);  \
-  }                                                    \
-  if (ImGui::IsKeyReleased(ImGuiKey_##KEY)) {          \
-    ((gb::GameBoy*) g_gameboy)->joypad_.ACTION(false); \
+#define DEF_KEY(KEY, BUTTON)                            \
+  if (ImGui::IsKeyPressed(ImGuiKey_##KEY)) {            \
+    GameBoyPress(g_gameboy, gb::Joypad::BUTTON, true);  \
+  }                                                     \
+  if (ImGui::IsKeyReleased(ImGuiKey_##KEY)) {           \
+    GameBoyPress(g_gameboy, gb::Joypad::BUTTON, false); \
   }
 
-      DEF_KEY(A, Left)
-      DEF_KEY(W, Up)
-      DEF_KEY(D, Right)
-      DEF_KEY(S, Down)
+      DEF_KEY(A, kLEFT)
+      DEF_KEY(W, kUP)
+      DEF_KEY(D, kRIGHT)
+      DEF_KEY(S, kDOWN)
 
-      DEF_KEY(J, A)
-      DEF_KEY(K, B)
-      DEF_KEY(Enter, Start)
-      DEF_KEY(Space, Select)
+      DEF_KEY(J, kA)
+      DEF_KEY(K, kB)
+      DEF_KEY(Enter, kSTART)
+      DEF_KEY(Space, kSELECT)
+    }
+
+    // F5 starts or stops recording <rom>.gbm, F6 plays it back
+    if (g_gameboy) {
+      auto* gameboy   = (gb::GameBoy*) g_gameboy;
+      auto movie_path = gameboy->cartridge_->romImage()->path() + ".gbm";
+      if (ImGui::IsKeyPressed(ImGuiKey_F5, false)) {
+        if (gameboy->movieMode() == gb::GameBoy::MovieMode::kRECORD) {
+          GameBoyMovieStop(g_gameboy, movie_path.c_str());
+        } else {
+          GameBoyMovieRecord(g_gameboy);
+        }
+      }
+      if (ImGui::IsKeyPressed(ImGuiKey_F6, false)) {
+        GameBoyMoviePlay(g_gameboy, movie_path.c_str());
+      }
+
+      // hold Tab to fast forward
+      gameboy->rtc_.turbo(ImGui::IsKeyDown(ImGuiKey_Tab));
+    }
+
+    // hold Backspace to rewind, 2 frames back for the one emulated meanwhile
+    if (ImGui::IsKeyDown(ImGuiKey_Backspace)) {
+      GameBoyRewind(g_gameboy, 2);
     }
 
     // Rendering
@@ -151,6 +178,7 @@ int main(int argc, char* argv[]) {
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+    GB_TRACE_SCOPE("swap buffers");
     glfwSwapBuffers(window);
   };
 
@@ -0,0 +1,77 @@
+// cartridge_rtc_test.cpp
+#include "cartridge/cartridge_rtc.h"
+
+#include <gtest/gtest.h>
+
+namespace gb {
+
+class FakeClock : public ClockSource {
+public:
+  u64 cycles() const override { return cycles_; }
+
+  void seconds(u64 n) { cycles_ += n * FREQUENCY; }
+
+  u64 cycles_{};
+};
+
+class CartridgeRTCTest : public ::testing::Test {
+protected:
+  void SetUp() override { rtc_.clockSource(&clock_); }
+
+  void latch() {
+    rtc_.latch(0x00);
+    rtc_.latch(0x01);
+  }
+
+  FakeClock clock_;
+  CartridgeRTC rtc_;
+};
+
+TEST_F(CartridgeRTCTest, CountsEmulatedTime) {
+  clock_.seconds(3661);
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 1);
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kMINUTES), 1);
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kHOURS), 1);
+}
+
+TEST_F(CartridgeRTCTest, RegistersOnlyChangeOnLatch) {
+  latch();
+  clock_.seconds(5);
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 0);
+  rtc_.latch(0x01); // not armed by a 0x00 write
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 0);
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 5);
+}
+
+TEST_F(CartridgeRTCTest, HaltStopsTheClock) {
+  rtc_.set(CartridgeRTC::kDAY_HIGH, CartridgeRTC::DAY_HIGH_HALT);
+  clock_.seconds(10);
+  rtc_.set(CartridgeRTC::kDAY_HIGH, 0);
+  clock_.seconds(2);
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 2);
+}
+
+TEST_F(CartridgeRTCTest, DayCounterOverflowSetsCarry) {
+  rtc_.set(CartridgeRTC::kDAY_LOW, 0xff);
+  rtc_.set(CartridgeRTC::kDAY_HIGH, CartridgeRTC::DAY_HIGH_DAY);
+  clock_.seconds(24 * 60 * 60);
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kDAY_LOW), 0);
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kDAY_HIGH), CartridgeRTC::DAY_HIGH_CARRY);
+}
+
+TEST_F(CartridgeRTCTest, WritingSecondsResetsPrescaler) {
+  clock_.cycles_ += ClockSource::FREQUENCY / 2;
+  rtc_.set(CartridgeRTC::kSECONDS, 0);
+  clock_.cycles_ += ClockSource::FREQUENCY / 2;
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 0);
+  clock_.cycles_ += ClockSource::FREQUENCY / 2;
+  latch();
+  EXPECT_EQ(rtc_.get(CartridgeRTC::kSECONDS), 1);
+}
+
+} // namespace gb
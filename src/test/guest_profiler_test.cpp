@@ -0,0 +1,66 @@
+// guest_profiler_test.cpp
+#include "debugger/guest_profiler.h"
+
+#include <gtest/gtest.h>
+
+namespace gb {
+
+TEST(GuestProfilerTest, CallStacks) {
+  using P = GuestProfiler;
+  GuestProfiler profiler;
+  profiler.enable();
+
+  profiler.instruction(P::location(0, 0x150), P::location(0, 0x151), 0x00, 0xfffe, 0xfffe, 4);   // NOP
+  profiler.instruction(P::location(0, 0x151), P::location(1, 0x4000), 0xCD, 0xfffe, 0xfffc, 24); // CALL
+  profiler.instruction(P::location(1, 0x4000), P::location(1, 0x4002), 0x137, 0xfffc, 0xfffc, 8); // SWAP A
+  profiler.interrupt(P::location(0, 0x40), 0xfffa, 20);
+  profiler.instruction(P::location(0, 0x40), P::location(1, 0x4002), 0xD9, 0xfffa, 0xfffc, 16);  // RETI
+  profiler.instruction(P::location(1, 0x4002), P::location(0, 0x154), 0xC9, 0xfffc, 0xfffe, 16); // RET
+  // CALL NZ, not taken
+  profiler.instruction(P::location(0, 0x154), P::location(0, 0x157), 0xC4, 0xfffe, 0xfffe, 12);
+  profiler.halted(4);
+
+  EXPECT_EQ(profiler.opcodeCount(0xCD), 1);
+  EXPECT_EQ(profiler.opcodeCount(0x137), 1);
+  EXPECT_EQ(profiler.opcodeCount(0x37), 0);
+
+  auto hotspots = profiler.hotspots(1);
+  ASSERT_EQ(hotspots.size(), 1);
+  EXPECT_EQ(hotspots[0].location, P::location(0, 0x151));
+  EXPECT_EQ(hotspots[0].cycles, 24);
+
+  EXPECT_EQ(profiler.foldedStacks(),
+            "root 40\n"
+            "root;01:4000 24\n"
+            "root;01:4000;00:0040 (irq) 36\n"
+            "root;halt 4\n");
+
+  auto functions = profiler.functions();
+  ASSERT_EQ(functions.size(), 2);
+  EXPECT_EQ(functions[0].entry, P::location(0, 0x40));
+  EXPECT_TRUE(functions[0].interrupt);
+  EXPECT_EQ(functions[1].entry, P::location(1, 0x4000));
+  EXPECT_EQ(functions[1].calls, 1);
+  EXPECT_EQ(functions[1].self_cycles, 24);
+  EXPECT_EQ(functions[1].total_cycles, 60);
+}
+
+// code popping its return address and jumping leaves a frame, the next RET past it unwinds it.
+TEST(GuestProfilerTest, UnwindsAbandonedFrames) {
+  using P = GuestProfiler;
+  GuestProfiler profiler;
+  profiler.enable();
+
+  profiler.instruction(P::location(0, 0x150), P::location(0, 0x200), 0xCD, 0xfffe, 0xfffc, 24); // CALL
+  profiler.instruction(P::location(0, 0x200), P::location(0, 0x300), 0xCD, 0xfffc, 0xfffa, 24); // CALL
+  profiler.instruction(P::location(0, 0x300), P::location(0, 0x301), 0xE1, 0xfffa, 0xfffc, 12); // POP HL
+  profiler.instruction(P::location(0, 0x301), P::location(0, 0x153), 0xC9, 0xfffc, 0xfffe, 16); // RET
+  profiler.instruction(P::location(0, 0x153), P::location(0, 0x154), 0x00, 0xfffe, 0xfffe, 4);  // NOP
+
+  EXPECT_EQ(profiler.foldedStacks(),
+            "root 28\n"
+            "root;00:0200 24\n"
+            "root;00:0200;00:0300 28\n");
+}
+
+} // namespace gb
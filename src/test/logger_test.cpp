@@ -0,0 +1,81 @@
+// logger_test.cpp
+#include "common/logger.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gb {
+
+// the written log of `log`, the backend is drained before std::cout is switched back.
+template<typename F>
+static std::string captureLog(F &&log) {
+  std::ostringstream out;
+  utils::flushLog();
+  auto *original_buffer = std::cout.rdbuf(out.rdbuf());
+  log();
+  utils::flushLog();
+  std::cout.rdbuf(original_buffer);
+  return out.str();
+}
+
+// for the tests logging at INFO, which a build with a higher GB_LOG_LEVEL leaves out.
+#define GB_SKIP_WITHOUT_INFO_LOG()                     \
+  do {                                                 \
+    if (!GB_LOG_IS_ENABLE(::utils::LogLevel::kINFO)) { \
+      GTEST_SKIP() << "INFO is not compiled in";       \
+    }                                                  \
+  } while (0)
+
+TEST(LoggerTest, JsonFormat) {
+  GB_SKIP_WITHOUT_INFO_LOG();
+  utils::LogBackend::instance().format(utils::LogFormat::kJSON);
+  auto log = captureLog([] { GB_LOG(INFO) << "a \"quoted\"\n" << 42; });
+  utils::LogBackend::instance().format(utils::LogFormat::kTEXT);
+
+  EXPECT_EQ(log.back(), '\n');
+  EXPECT_NE(log.find("\"level\": \"INFO\""), std::string::npos);
+  EXPECT_NE(log.find("logger_test.cpp\", \"line\": "), std::string::npos);
+  EXPECT_NE(log.find("\"message\": \"a \\\"quoted\\\"\\u000a42\"}"), std::string::npos);
+}
+
+// more than a ring holds, every message once and in order per thread.
+TEST(LoggerTest, ThreadsKeepTheirOrder) {
+  GB_SKIP_WITHOUT_INFO_LOG();
+  static constexpr int THREADS = 4, MESSAGES = 5000;
+  auto log = captureLog([] {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+      threads.emplace_back([t] {
+        for (int i = 0; i < MESSAGES; i++) {
+          GB_LOG(INFO) << "thread " << t << " message " << i;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  });
+
+  std::vector<int> next(THREADS);
+  std::istringstream lines(log);
+  for (std::string line; std::getline(lines, line);) {
+    int t = -1, i = -1;
+    auto pos = line.find("thread ");
+    ASSERT_NE(pos, std::string::npos) << line;
+    ASSERT_EQ(sscanf(line.c_str() + pos, "thread %d message %d", &t, &i), 2) << line;
+    ASSERT_EQ(i, next[t]++);
+  }
+  EXPECT_EQ(next, std::vector<int>(THREADS, MESSAGES));
+}
+
+TEST(LoggerTest, DisabledLevelsSkipTheirArguments) {
+  int evaluated = 0;
+  captureLog([&] { GB_LOG(TRACE) << ++evaluated; });
+  EXPECT_EQ(evaluated, GB_LOG_IS_ENABLE(::utils::LogLevel::kTRACE) ? 1 : 0);
+}
+
+} // namespace gb
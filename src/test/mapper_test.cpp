@@ -0,0 +1,173 @@
+// mapper_test.cpp
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cartridge/cartridge_factory.h"
+
+namespace gb {
+
+// a ROM of `banks` 16 KiB banks, each starting with its number (u16, little endian).
+static std::unique_ptr<Cartridge> makeCartridge(CartridgeHeader::Type type, u8 rom_size_code, u32 banks,
+                                                u8 ram_size_code) {
+  std::vector<u8> image(banks * 0x4000);
+  for (u32 bank = 0; bank < banks; bank++) {
+    image[bank * 0x4000]     = bank;
+    image[bank * 0x4000 + 1] = bank >> 8;
+  }
+  image[0x147] = type;
+  image[0x148] = rom_size_code;
+  image[0x149] = ram_size_code;
+
+  auto path = (std::filesystem::temp_directory_path() / ("gb_mapper_test_" + std::to_string(type) + ".gb"))
+                      .string();
+  std::ofstream(path, std::ios::binary).write((const char *) image.data(), image.size());
+  auto rom = Rom::open(path);
+  std::filesystem::remove(path); // the mapping keeps the data
+  return std::unique_ptr<Cartridge>(CartridgeFactory::Create(rom, false));
+}
+
+static u16 bankAt(const Cartridge &cartridge, u16 addr) {
+  return cartridge.get(addr) | cartridge.get(addr + 1) << 8;
+}
+
+using Writes = std::vector<std::pair<u16, u8>>;
+
+struct BankCase {
+  Writes writes;
+  u16 rom0{}; // bank at 0x0000
+  u16 romx{}; // bank at 0x4000
+};
+
+static void expectBanks(CartridgeHeader::Type type, u8 rom_size_code, u32 banks,
+                        const std::vector<BankCase> &cases) {
+  for (u32 i = 0; i < cases.size(); i++) {
+    auto cartridge = makeCartridge(type, rom_size_code, banks, 0);
+    for (auto [addr, val] : cases[i].writes) {
+      cartridge->set(addr, val);
+    }
+    EXPECT_EQ(bankAt(*cartridge, 0x0000), cases[i].rom0) << "case " << i;
+    EXPECT_EQ(bankAt(*cartridge, 0x4000), cases[i].romx) << "case " << i;
+  }
+}
+
+TEST(MapperTest, MBC1RomBanks) {
+  expectBanks(CartridgeHeader::kMBC1, 6, 128,
+              {
+                      {{}, 0, 1},
+                      {{{0x2000, 0x00}}, 0, 1}, // bank 0 reads as 1
+                      {{{0x2000, 0x20}}, 0, 1}, // the zero check sees the 5 bits
+                      {{{0x2000, 0x05}}, 0, 0x05},
+                      {{{0x4000, 0x01}, {0x2000, 0x00}}, 0, 0x21},
+                      {{{0x4000, 0x02}, {0x2000, 0x03}}, 0, 0x43},
+                      // mode 1 also maps the upper bits at 0x0000.
+                      {{{0x6000, 0x01}, {0x4000, 0x02}, {0x2000, 0x03}}, 0x40, 0x43},
+                      {{{0x6000, 0x01}, {0x4000, 0x03}, {0x6000, 0x00}}, 0, 0x61},
+              });
+}
+
+TEST(MapperTest, MBC1RamBanks) {
+  auto cartridge = makeCartridge(CartridgeHeader::kMBC1_RAM, 0, 2, 3);
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+  cartridge->set(0x0000, 0x0a);
+  cartridge->set(0xa000, 0x10);
+
+  // in mode 0 the RAM bank stays 0.
+  cartridge->set(0x4000, 0x02);
+  EXPECT_EQ(cartridge->get(0xa000), 0x10);
+  cartridge->set(0x6000, 0x01);
+  EXPECT_EQ(cartridge->get(0xa000), 0x00);
+  cartridge->set(0xa000, 0x12);
+  cartridge->set(0x6000, 0x00);
+  EXPECT_EQ(cartridge->get(0xa000), 0x10);
+
+  cartridge->set(0x0000, 0x00);
+  cartridge->set(0xa000, 0x99); // ignored
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+  cartridge->set(0x0000, 0x0a);
+  EXPECT_EQ(cartridge->get(0xa000), 0x10);
+}
+
+TEST(MapperTest, MBC2RomBanks) {
+  expectBanks(CartridgeHeader::kMBC2, 3, 16,
+              {
+                      {{}, 0, 1},
+                      {{{0x2100, 0x03}}, 0, 3},
+                      {{{0x2100, 0x00}}, 0, 1},
+                      {{{0x2100, 0x1f}}, 0, 0xf}, // 4 bits
+                      {{{0x0100, 0x0a}}, 0, 0xa}, // address bit 8 selects the ROM bank register
+                      {{{0x2000, 0x03}}, 0, 1},   // and without it the RAM enable
+              });
+}
+
+TEST(MapperTest, MBC2RamNibbles) {
+  auto cartridge = makeCartridge(CartridgeHeader::kMBC2, 0, 2, 0);
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+  cartridge->set(0x0000, 0x0a);
+  cartridge->set(0xa000, 0xab);
+  cartridge->set(0xa1ff, 0x05);
+
+  // the upper nibble reads as 1s, the 512 bytes repeat up to 0xbfff.
+  EXPECT_EQ(cartridge->get(0xa000), 0xfb);
+  for (u16 addr : {0xa200, 0xb000, 0xbe00}) {
+    EXPECT_EQ(cartridge->get(addr), 0xfb) << std::hex << addr;
+  }
+  EXPECT_EQ(cartridge->get(0xbfff), 0xf5);
+
+  cartridge->set(0x0000, 0x00);
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+}
+
+TEST(MapperTest, RomRam) {
+  auto cartridge = makeCartridge(CartridgeHeader::kROM_RAM, 0, 2, 2);
+  EXPECT_EQ(bankAt(*cartridge, 0x4000), 1);
+  cartridge->set(0x2000, 0x00); // no mapper, ignored
+  EXPECT_EQ(bankAt(*cartridge, 0x4000), 1);
+  // the RAM needs no enable.
+  cartridge->set(0xa000, 0x34);
+  EXPECT_EQ(cartridge->get(0xa000), 0x34);
+}
+
+TEST(MapperTest, MBC5RomBanks) {
+  expectBanks(CartridgeHeader::kMBC5, 8, 512,
+              {
+                      {{}, 0, 1},
+                      {{{0x2000, 0x00}}, 0, 0}, // bank 0 is selectable
+                      {{{0x2000, 0x42}}, 0, 0x42},
+                      {{{0x2000, 0xff}, {0x3000, 0x01}}, 0, 0x1ff},
+                      {{{0x3000, 0x01}, {0x2000, 0x00}}, 0, 0x100},
+                      {{{0x3000, 0x03}, {0x2000, 0x05}}, 0, 0x105}, // only bit 0 is the 9th bit
+              });
+}
+
+TEST(MapperTest, MBC5RamAndRumble) {
+  auto cartridge = makeCartridge(CartridgeHeader::kMBC5_RUMBLE_RAM, 0, 2, 3);
+  std::vector<bool> motor;
+  cartridge->rumbleCallback([&](bool on) { motor.push_back(on); });
+
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+  cartridge->set(0xa000, 0x12); // ignored, disabled
+  cartridge->set(0x0000, 0x1a); // only 0x0a enables
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+  cartridge->set(0x0000, 0x0a);
+  EXPECT_EQ(cartridge->get(0xa000), 0x00);
+
+  // bit 3 drives the motor, the RAM bank has 3 bits.
+  cartridge->set(0x4000, 0x09);
+  cartridge->set(0xa000, 0x11);
+  cartridge->set(0x4000, 0x01);
+  EXPECT_EQ(cartridge->get(0xa000), 0x11);
+  cartridge->set(0x4000, 0x00);
+  EXPECT_EQ(cartridge->get(0xa000), 0x00);
+  EXPECT_EQ(motor, (std::vector<bool>{true, false}));
+
+  cartridge->set(0x0000, 0x00);
+  EXPECT_EQ(cartridge->get(0xa000), 0xff);
+}
+
+} // namespace gb
@@ -0,0 +1,92 @@
+// movie_test.cpp
+#include "machine/movie.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "machine/gameboy.h"
+#include "test_base.h"
+
+namespace gb {
+
+// stop on the first instruction boundary at or after `cycles` of the bus clock,
+// the scheduler clock of two instances is not in phase.
+static void runTo(GameBoy &gb, u64 cycles) {
+  while (gb.memory_bus_.cycles() < cycles) {
+    gb.rtc_.step(cycles - gb.memory_bus_.cycles());
+  }
+}
+
+TEST(MovieTest, PlaybackReproducesRecording) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoyOptions options{.audio = false, .battery_save = false, .rewind_budget = 0};
+  GameBoy recorder(TEST_ROM, options);
+  recorder.rtc_.step(RTC::CYCLES_PER_FRAME * 10 + 1234);
+  recorder.recordMovie();
+  u64 begin = recorder.memory_bus_.cycles();
+
+  // presses land in the middle of frames, they are applied at the next input frame.
+  u8 masks[] = {Joypad::kSTART, 0, Joypad::kA | Joypad::kRIGHT, Joypad::kDOWN, 0};
+  for (u8 mask : masks) {
+    recorder.rtc_.step(RTC::CYCLES_PER_FRAME * 3 + 777);
+    recorder.press(0xff, false);
+    recorder.press(mask, true);
+  }
+  u64 end = recorder.memory_bus_.cycles() + RTC::CYCLES_PER_FRAME;
+  runTo(recorder, end);
+  auto movie = recorder.stopMovie();
+  ASSERT_GE(movie.frames.size(), 15);
+  EXPECT_EQ(movie.frames[0], 0);
+  std::vector<u8> expected(recorder.stateSize());
+  ASSERT_EQ(recorder.saveState(expected), expected.size());
+
+  auto path = std::filesystem::temp_directory_path() / "gb_movie_test.gbm";
+  ASSERT_TRUE(movie.save(path.string()));
+  Movie loaded;
+  ASSERT_TRUE(loaded.load(path.string()));
+  std::filesystem::remove(path);
+  EXPECT_EQ(loaded.rom_hash, movie.rom_hash);
+  EXPECT_EQ(loaded.initial_state, movie.initial_state);
+  EXPECT_EQ(loaded.frames, movie.frames);
+
+  GameBoy player(TEST_ROM, options);
+  player.rtc_.step(RTC::CYCLES_PER_FRAME * 3 + 99);
+  player.press(Joypad::kB, true); // ignored while playing
+  ASSERT_TRUE(player.playMovie(std::move(loaded)));
+  EXPECT_EQ(player.memory_bus_.cycles(), begin);
+  runTo(player, end);
+  std::vector<u8> actual(player.stateSize());
+  ASSERT_EQ(player.saveState(actual), actual.size());
+  EXPECT_EQ(actual, expected);
+}
+
+TEST(MovieTest, NoRewindWhileRecording) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoyOptions options{.audio = false, .battery_save = false, .rewind_budget = 1 << 20};
+  GameBoy rewound(TEST_ROM, options), reference(TEST_ROM, options);
+  for (auto *gb : {&rewound, &reference}) {
+    gb->recordMovie();
+    gb->rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  }
+  rewound.rewind(10);
+  for (auto *gb : {&rewound, &reference}) {
+    gb->rtc_.step(RTC::CYCLES_PER_FRAME * 2);
+  }
+
+  EXPECT_EQ(rewound.memory_bus_.cycles(), reference.memory_bus_.cycles());
+  EXPECT_EQ(rewound.stopMovie().frames, reference.stopMovie().frames);
+}
+
+TEST(MovieTest, RejectsOtherGame) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoy gb(TEST_ROM, {.audio = false, .battery_save = false, .rewind_budget = 0});
+  gb.recordMovie();
+  auto movie = gb.stopMovie();
+  movie.rom_hash++;
+  EXPECT_FALSE(gb.playMovie(movie));
+  EXPECT_EQ(gb.movieMode(), GameBoy::MovieMode::kNONE);
+}
+
+} // namespace gb
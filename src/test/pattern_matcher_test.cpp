@@ -0,0 +1,55 @@
+// pattern_matcher_test.cpp
+#include "common/pattern_matcher.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "machine/serial/serial_buffer.h"
+
+namespace gb {
+
+// the index of every match, in the order they end.
+static std::vector<u32> matches(PatternMatcher &matcher, const std::string &text) {
+  std::vector<u32> found;
+  for (u8 byte : text) {
+    if (u32 match = matcher.feed(byte); match != PatternMatcher::NONE) {
+      found.push_back(match);
+    }
+  }
+  return found;
+}
+
+TEST(PatternMatcherTest, MatchesAcrossFeeds) {
+  PatternMatcher matcher({"Passed", "Failed"});
+  EXPECT_TRUE(matches(matcher, "01:ok\nPass").empty());
+  EXPECT_EQ(matches(matcher, "ed\n"), std::vector<u32>{0});
+  EXPECT_EQ(matches(matcher, "PaFailed"), std::vector<u32>{1});
+}
+
+TEST(PatternMatcherTest, FollowsFailureLinks) {
+  // "abab" restarts within itself, "bc" ends inside "abc".
+  PatternMatcher matcher({"abab", "abc", "bc"});
+  EXPECT_EQ(matches(matcher, "abababc"), (std::vector<u32>{0, 0, 1}));
+  matcher.reset();
+  EXPECT_EQ(matches(matcher, "xbc"), std::vector<u32>{2});
+}
+
+TEST(PatternMatcherTest, LowestIndexWins) {
+  PatternMatcher matcher({"BBB", "B", std::string{3, 5, 8}});
+  EXPECT_EQ(matches(matcher, "xBB"), (std::vector<u32>{1, 1}));
+  EXPECT_EQ(matches(matcher, "B"), std::vector<u32>{0});
+  EXPECT_EQ(matches(matcher, std::string{0, 3, 5, 8}), std::vector<u32>{2});
+}
+
+TEST(SerialBufferTest, KeepsTheTail) {
+  SerialBuffer buffer(4);
+  for (u8 byte : std::string("Passed")) {
+    buffer.push(byte);
+  }
+  EXPECT_EQ(buffer.total(), 6);
+  EXPECT_EQ(buffer.bytes(), (std::vector<u8>{'s', 's', 'e', 'd'}));
+}
+
+} // namespace gb
@@ -0,0 +1,457 @@
+#include "png.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace gb {
+
+static constexpr u8 SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+static u32 crc32(const u8 *data, size_t size, u32 crc = 0) {
+  static const auto table = [] {
+    std::vector<u32> t(256);
+    for (u32 n = 0; n < 256; n++) {
+      u32 c = n;
+      for (int k = 0; k < 8; k++) {
+        c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+static u32 adler32(const u8 *data, size_t size) {
+  u32 a = 1, b = 0;
+  for (size_t i = 0; i < size; i++) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+static u32 getBE32(const u8 *p) { return (u32) p[0] << 24 | (u32) p[1] << 16 | (u32) p[2] << 8 | p[3]; }
+
+static void putBE32(std::vector<u8> &out, u32 val) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out.push_back(val >> shift);
+  }
+}
+
+static void putChunk(std::vector<u8> &out, const char *type, const std::vector<u8> &data) {
+  putBE32(out, data.size());
+  size_t begin = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  putBE32(out, crc32(&out[begin], out.size() - begin));
+}
+
+// RFC 1951 decoder, after zlib's puff: canonical Huffman codes decoded one bit at a time.
+// screenshots are small, simplicity wins over speed.
+class Inflater {
+public:
+  Inflater(std::span<const u8> in, std::vector<u8> &out) : in_(in), out_(out) {}
+
+  bool run() {
+    bool last;
+    do {
+      last     = bits(1);
+      u32 type = bits(2);
+      bool ok  = type == 0 ? stored() : type == 1 ? fixed() : type == 2 ? dynamic() : false;
+      if (!ok || error_) {
+        return false;
+      }
+    } while (!last);
+    return true;
+  }
+
+private:
+  static constexpr u32 MAX_BITS  = 15;
+  static constexpr u32 MAX_LCODE = 286;
+  static constexpr u32 MAX_DCODE = 30;
+
+  struct Huffman {
+    u16 count[MAX_BITS + 1]{}; // codes of each length
+    u16 symbol[288]{};         // symbols ordered by code
+  };
+
+  u32 bits(u32 n) {
+    while (bit_count_ < n) {
+      if (pos_ >= in_.size()) {
+        error_ = true;
+        return 0;
+      }
+      bit_buffer_ |= (u32) in_[pos_++] << bit_count_;
+      bit_count_ += 8;
+    }
+    u32 val = bit_buffer_ & ((1u << n) - 1);
+    bit_buffer_ >>= n;
+    bit_count_ -= n;
+    return val;
+  }
+
+  // false if the lengths over-subscribe the code space, incomplete codes are allowed.
+  static bool build(Huffman &h, const u8 *lengths, u32 n) {
+    memset(h.count, 0, sizeof(h.count));
+    for (u32 sym = 0; sym < n; sym++) {
+      h.count[lengths[sym]]++;
+    }
+    int left = 1;
+    for (u32 len = 1; len <= MAX_BITS; len++) {
+      left = (left << 1) - h.count[len];
+      if (left < 0) {
+        return false;
+      }
+    }
+    u16 offsets[MAX_BITS + 1]{};
+    for (u32 len = 1; len < MAX_BITS; len++) {
+      offsets[len + 1] = offsets[len] + h.count[len];
+    }
+    for (u32 sym = 0; sym < n; sym++) {
+      if (lengths[sym] != 0) {
+        h.symbol[offsets[lengths[sym]]++] = sym;
+      }
+    }
+    return true;
+  }
+
+  int decode(const Huffman &h) {
+    int code = 0, first = 0, index = 0;
+    for (u32 len = 1; len <= MAX_BITS; len++) {
+      code |= bits(1);
+      int count = h.count[len];
+      if (code - count < first) {
+        return h.symbol[index + (code - first)];
+      }
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    error_ = true;
+    return -1;
+  }
+
+  bool stored() {
+    bit_buffer_ = 0;
+    bit_count_  = 0;
+    if (pos_ + 4 > in_.size()) {
+      return false;
+    }
+    u32 len  = in_[pos_] | in_[pos_ + 1] << 8;
+    u32 nlen = in_[pos_ + 2] | in_[pos_ + 3] << 8;
+    pos_ += 4;
+    if (len != (~nlen & 0xffff) || pos_ + len > in_.size()) {
+      return false;
+    }
+    out_.insert(out_.end(), in_.begin() + pos_, in_.begin() + pos_ + len);
+    pos_ += len;
+    return true;
+  }
+
+  bool codes(const Huffman &lcode, const Huffman &dcode) {
+    static constexpr u16 LENGTH_BASE[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                          31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr u8 LENGTH_EXTRA[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr u16 DIST_BASE[]   = {1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+                                          33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+                                          1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static constexpr u8 DIST_EXTRA[]   = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                          6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    while (true) {
+      int sym = decode(lcode);
+      if (error_ || sym < 0) {
+        return false;
+      }
+      if (sym < 256) {
+        out_.push_back(sym);
+        continue;
+      }
+      if (sym == 256) {
+        return true;
+      }
+      sym -= 257;
+      if (sym >= 29) {
+        return false;
+      }
+      u32 len  = LENGTH_BASE[sym] + bits(LENGTH_EXTRA[sym]);
+      int dsym = decode(dcode);
+      if (error_ || dsym < 0 || dsym >= 30) {
+        return false;
+      }
+      u32 dist = DIST_BASE[dsym] + bits(DIST_EXTRA[dsym]);
+      if (error_ || dist > out_.size()) {
+        return false;
+      }
+      // the source may overlap the bytes being written.
+      for (u32 i = 0; i < len; i++) {
+        out_.push_back(out_[out_.size() - dist]);
+      }
+    }
+  }
+
+  bool fixed() {
+    static const auto tables = [] {
+      std::pair<Huffman, Huffman> t;
+      u8 lengths[288];
+      for (u32 sym = 0; sym < 288; sym++) {
+        lengths[sym] = sym < 144 ? 8 : sym < 256 ? 9 : sym < 280 ? 7 : 8;
+      }
+      build(t.first, lengths, 288);
+      memset(lengths, 5, MAX_DCODE);
+      build(t.second, lengths, MAX_DCODE);
+      return t;
+    }();
+    return codes(tables.first, tables.second);
+  }
+
+  bool dynamic() {
+    static constexpr u8 ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    u32 nlen  = bits(5) + 257;
+    u32 ndist = bits(5) + 1;
+    u32 ncode = bits(4) + 4;
+    if (error_ || nlen > MAX_LCODE || ndist > MAX_DCODE) {
+      return false;
+    }
+
+    u8 lengths[MAX_LCODE + MAX_DCODE]{};
+    for (u32 i = 0; i < ncode; i++) {
+      lengths[ORDER[i]] = bits(3);
+    }
+    Huffman lencode, distcode;
+    if (!build(lencode, lengths, 19)) {
+      return false;
+    }
+
+    memset(lengths, 0, sizeof(lengths));
+    for (u32 index = 0; index < nlen + ndist;) {
+      int sym = decode(lencode);
+      if (error_ || sym < 0) {
+        return false;
+      }
+      if (sym < 16) {
+        lengths[index++] = sym;
+        continue;
+      }
+      u8 len = 0;
+      u32 repeat;
+      if (sym == 16) {
+        if (index == 0) {
+          return false;
+        }
+        len    = lengths[index - 1];
+        repeat = 3 + bits(2);
+      } else if (sym == 17) {
+        repeat = 3 + bits(3);
+      } else {
+        repeat = 11 + bits(7);
+      }
+      if (index + repeat > nlen + ndist) {
+        return false;
+      }
+      while (repeat--) {
+        lengths[index++] = len;
+      }
+    }
+    // no end of block code.
+    if (lengths[256] == 0) {
+      return false;
+    }
+    if (!build(lencode, lengths, nlen) || !build(distcode, lengths + nlen, ndist)) {
+      return false;
+    }
+    return codes(lencode, distcode);
+  }
+
+  std::span<const u8> in_;
+  std::vector<u8> &out_;
+  size_t pos_{};
+  u32 bit_buffer_{};
+  u32 bit_count_{};
+  bool error_{};
+};
+
+static u8 paeth(u8 a, u8 b, u8 c) {
+  int p  = a + b - c;
+  int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+  return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+std::vector<u8> encodePng(const Image &image) {
+  std::vector<u8> out(std::begin(SIGNATURE), std::end(SIGNATURE));
+
+  std::vector<u8> header;
+  putBE32(header, image.width);
+  putBE32(header, image.height);
+  header.insert(header.end(), {8 /*depth*/, 2 /*RGB*/, 0, 0, 0 /*no interlace*/});
+  putChunk(out, "IHDR", header);
+
+  std::vector<u8> raw;
+  u32 stride = image.width * 3;
+  for (u32 y = 0; y < image.height; y++) {
+    raw.push_back(0); // no filter
+    raw.insert(raw.end(), image.rgb.begin() + y * stride, image.rgb.begin() + (y + 1) * stride);
+  }
+  std::vector<u8> zlib{0x78, 0x01};
+  size_t pos = 0;
+  do {
+    u16 len   = std::min<size_t>(raw.size() - pos, 0xffff);
+    bool last = pos + len == raw.size();
+    zlib.insert(zlib.end(), {(u8) last, (u8) len, (u8) (len >> 8), (u8) ~len, (u8) (~len >> 8)});
+    zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+    pos += len;
+  } while (pos < raw.size());
+  putBE32(zlib, adler32(raw.data(), raw.size()));
+  putChunk(out, "IDAT", zlib);
+  putChunk(out, "IEND", {});
+  return out;
+}
+
+bool decodePng(std::span<const u8> data, Image &image) {
+  if (data.size() < sizeof(SIGNATURE) || memcmp(data.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) {
+    return false;
+  }
+  u32 width = 0, height = 0;
+  u8 depth = 0, color_type = 0;
+  std::vector<u8> palette, zlib;
+  for (size_t pos = sizeof(SIGNATURE); pos + 12 <= data.size();) {
+    u32 len = getBE32(&data[pos]);
+    if (len > data.size() - pos - 12) {
+      return false;
+    }
+    const u8 *type  = &data[pos + 4];
+    const u8 *chunk = &data[pos + 8];
+    if (getBE32(chunk + len) != crc32(type, len + 4)) {
+      return false;
+    }
+    if (memcmp(type, "IHDR", 4) == 0 && len == 13) {
+      width      = getBE32(chunk);
+      height     = getBE32(chunk + 4);
+      depth      = chunk[8];
+      color_type = chunk[9];
+      if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0 /*interlaced*/) {
+        return false;
+      }
+    } else if (memcmp(type, "PLTE", 4) == 0) {
+      palette.assign(chunk, chunk + len);
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      zlib.insert(zlib.end(), chunk, chunk + len);
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      break;
+    }
+    pos += len + 12;
+  }
+
+  static constexpr u8 CHANNELS[] = {1, 0, 3, 1, 2, 0, 4};
+  if (width == 0 || height == 0 || color_type > 6 || CHANNELS[color_type] == 0
+      || (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16)) {
+    return false;
+  }
+  // zlib header: deflate, no preset dictionary.
+  if (zlib.size() < 2 || (zlib[0] & 0x0f) != 8 || (zlib[1] & 0x20) != 0) {
+    return false;
+  }
+  std::vector<u8> raw;
+  if (!Inflater({zlib.data() + 2, zlib.size() - 2}, raw).run()) {
+    return false;
+  }
+
+  u32 channels = CHANNELS[color_type];
+  u32 bpp      = std::max(1u, channels * depth / 8);
+  size_t row   = ((size_t) width * channels * depth + 7) / 8;
+  if (raw.size() < (row + 1) * height) {
+    return false;
+  }
+  std::vector<u8> pixels(row * height);
+  for (u32 y = 0; y < height; y++) {
+    u8 filter      = raw[y * (row + 1)];
+    const u8 *src  = &raw[y * (row + 1) + 1];
+    u8 *cur        = &pixels[y * row];
+    const u8 *prev = y ? cur - row : nullptr;
+    for (size_t x = 0; x < row; x++) {
+      u8 a = x >= bpp ? cur[x - bpp] : 0;
+      u8 b = prev ? prev[x] : 0;
+      u8 c = prev && x >= bpp ? prev[x - bpp] : 0;
+      switch (filter) {
+        case 0:
+          cur[x] = src[x];
+          break;
+        case 1:
+          cur[x] = src[x] + a;
+          break;
+        case 2:
+          cur[x] = src[x] + b;
+          break;
+        case 3:
+          cur[x] = src[x] + ((a + b) >> 1);
+          break;
+        case 4:
+          cur[x] = src[x] + paeth(a, b, c);
+          break;
+        default:
+          return false;
+      }
+    }
+  }
+
+  // the `i`th sample of a row, palette indices unscaled, everything else scaled to 8 bits.
+  auto sample = [&](const u8 *line, size_t i) -> u8 {
+    if (depth == 16) {
+      return line[i * 2];
+    }
+    if (depth == 8) {
+      return line[i];
+    }
+    u8 val = (line[i * depth / 8] >> (8 - depth - i * depth % 8)) & ((1 << depth) - 1);
+    return color_type == 3 ? val : val * 255 / ((1 << depth) - 1);
+  };
+  image.width  = width;
+  image.height = height;
+  image.rgb.resize((size_t) width * height * 3);
+  for (u32 y = 0; y < height; y++) {
+    const u8 *line = &pixels[y * row];
+    for (u32 x = 0; x < width; x++) {
+      u8 *rgb = &image.rgb[((size_t) y * width + x) * 3];
+      if (color_type == 3) {
+        u32 index = sample(line, x);
+        if (index * 3 + 2 >= palette.size()) {
+          return false;
+        }
+        memcpy(rgb, &palette[index * 3], 3);
+      } else if (channels >= 3) {
+        for (u32 c = 0; c < 3; c++) {
+          rgb[c] = sample(line, (size_t) x * channels + c);
+        }
+      } else {
+        memset(rgb, sample(line, (size_t) x * channels), 3);
+      }
+    }
+  }
+  return true;
+}
+
+bool writePng(const std::string &path, const Image &image) {
+  auto data = encodePng(image);
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(data.data()), data.size());
+  return !!file;
+}
+
+bool readPng(const std::string &path, Image &image) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::vector<u8> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  return decodePng(data, image);
+}
+
+} // namespace gb
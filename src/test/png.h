@@ -0,0 +1,27 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/type.h"
+
+namespace gb {
+
+struct Image {
+  u32 width{};
+  u32 height{};
+  std::vector<u8> rgb; // width x height x 3, row major
+};
+
+// Minimal PNG codec for the screenshot tests. encodes 8-bit RGB with stored (uncompressed)
+// deflate blocks, decodes any color type and bit depth without interlacing, alpha is dropped.
+std::vector<u8> encodePng(const Image &image);
+
+bool decodePng(std::span<const u8> data, Image &image);
+
+bool writePng(const std::string &path, const Image &image);
+
+bool readPng(const std::string &path, Image &image);
+
+} // namespace gb
@@ -0,0 +1,50 @@
+// png_test.cpp
+#include "png.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace gb {
+
+TEST(PngTest, RoundTrip) {
+  Image image;
+  image.width  = 37;
+  image.height = 5;
+  for (u32 i = 0; i < image.width * image.height * 3; i++) {
+    image.rgb.push_back(i * 7);
+  }
+  Image decoded;
+  ASSERT_TRUE(decodePng(encodePng(image), decoded));
+  EXPECT_EQ(decoded.width, image.width);
+  EXPECT_EQ(decoded.height, image.height);
+  EXPECT_EQ(decoded.rgb, image.rgb);
+}
+
+// 4x3 8-bit gray written by zlib (fixed Huffman codes), rows filtered with none, sub and up.
+TEST(PngTest, DecodeCompressedGray) {
+  const std::vector<u8> png{
+          0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+          0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03, 0x08, 0x00, 0x00, 0x00, 0x00, 0x91, 0x9f, 0xf1,
+          0x1a, 0x00, 0x00, 0x00, 0x18, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x08, 0x5d, 0xf5,
+          0x9f, 0xf1, 0xff, 0xea, 0xd5, 0xab, 0x99, 0x18, 0xc3, 0x56, 0xfd, 0x07, 0x00, 0x31, 0xb8, 0x07,
+          0x02, 0x65, 0xcf, 0x75, 0x05, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60,
+          0x82,
+  };
+  const u8 gray[] = {0, 85, 170, 255, 255, 170, 85, 0, 0, 0, 255, 255};
+
+  Image image;
+  ASSERT_TRUE(decodePng(png, image));
+  ASSERT_EQ(image.width, 4);
+  ASSERT_EQ(image.height, 3);
+  for (u32 i = 0; i < 12; i++) {
+    EXPECT_EQ(image.rgb[i * 3], gray[i]);
+    EXPECT_EQ(image.rgb[i * 3 + 2], gray[i]);
+  }
+
+  auto corrupt = png;
+  corrupt[50] ^= 0xff; // IDAT data, the chunk CRC no longer matches
+  EXPECT_FALSE(decodePng(corrupt, image));
+}
+
+} // namespace gb
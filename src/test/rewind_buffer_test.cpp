@@ -0,0 +1,99 @@
+// rewind_buffer_test.cpp
+#include "machine/rewind_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "machine/gameboy.h"
+#include "test_base.h"
+
+namespace gb {
+
+static std::vector<u8> makeState(u32 size, u32 frame) {
+  std::vector<u8> state(size, 0x5a);
+  // a few bytes change every frame, like the timers and the stack.
+  for (u32 i = 0; i < 16; i++) {
+    state[(frame * 97 + i * 131) % size] = frame + i;
+  }
+  return state;
+}
+
+TEST(RewindBufferTest, CodecRoundTrip) {
+  std::vector<u8> a(1000, 0), b(1000, 0), encoded;
+  for (u32 i = 0; i < a.size(); i += 7) {
+    a[i] = i;
+  }
+  a[999] = 1;
+  a[500] = a[501] = 0xff;
+
+  RewindBuffer::encode(a, b, encoded);
+  std::vector<u8> out(b);
+  RewindBuffer::decode(encoded, out);
+  EXPECT_EQ(out, a);
+
+  // identical states encode to a single zero run.
+  RewindBuffer::encode(a, a, encoded);
+  EXPECT_LE(encoded.size(), 4);
+}
+
+TEST(RewindBufferTest, SeekRestoresEverySnapshot) {
+  RewindBuffer buffer(1 << 20, 8);
+  constexpr u32 SIZE = 4096;
+  for (u32 frame = 0; frame < 30; frame++) {
+    buffer.push(makeState(SIZE, frame));
+  }
+  // deltas are much smaller than the states.
+  EXPECT_LT(buffer.bytes(), SIZE * 8);
+
+  std::vector<u8> out;
+  ASSERT_TRUE(buffer.seek(0, out));
+  EXPECT_EQ(out, makeState(SIZE, 29));
+  ASSERT_TRUE(buffer.seek(5, out));
+  EXPECT_EQ(out, makeState(SIZE, 24));
+  EXPECT_EQ(buffer.size(), 25);
+
+  // history continues from the restored snapshot.
+  buffer.push(makeState(SIZE, 100));
+  ASSERT_TRUE(buffer.seek(1, out));
+  EXPECT_EQ(out, makeState(SIZE, 24));
+  ASSERT_TRUE(buffer.seek(1000, out));
+  EXPECT_EQ(out, makeState(SIZE, 0));
+}
+
+TEST(RewindBufferTest, BudgetDropsOldestKeyframe) {
+  constexpr u32 SIZE = 4096;
+  RewindBuffer buffer(SIZE * 4, 4);
+  for (u32 frame = 0; frame < 100; frame++) {
+    buffer.push(makeState(SIZE, frame));
+    EXPECT_LE(buffer.bytes(), buffer.budget());
+  }
+  ASSERT_FALSE(buffer.empty());
+  EXPECT_LT(buffer.size(), 100);
+
+  u32 oldest = 100 - buffer.size();
+  std::vector<u8> out;
+  ASSERT_TRUE(buffer.seek(buffer.size() - 1, out));
+  EXPECT_EQ(out, makeState(SIZE, oldest));
+  EXPECT_EQ(buffer.size(), 1);
+}
+
+TEST(RewindBufferTest, GameBoyRewindsToEarlierFrame) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoy gb(TEST_ROM, {.audio = false, .battery_save = false, .rewind_budget = 1 << 20});
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 60);
+  std::vector<u8> expected(gb.stateSize());
+  ASSERT_EQ(gb.saveState(expected), expected.size());
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 9);
+
+  // the request is served at the next frame boundary, one more frame is emulated meanwhile.
+  gb.rewind(10);
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME);
+  // the tasks are still aligned on the bus clock.
+  EXPECT_EQ(gb.rtc_.scheduler().clock(), gb.memory_bus_.cycles());
+  std::vector<u8> actual(gb.stateSize());
+  ASSERT_EQ(gb.saveState(actual), actual.size());
+  EXPECT_EQ(actual, expected);
+}
+
+} // namespace gb
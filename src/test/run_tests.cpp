@@ -2,11 +2,15 @@
 
 #include <fstream>
 
+#include "common/logger.h"
+
 class StdoutSuppressor : public ::testing::EmptyTestEventListener {
   std::streambuf* original_buffer;
   std::ofstream null_stream;
 
+  // the log is written by another thread, flush it before switching the stream.
   void OnTestStart(const ::testing::TestInfo&) override {
+    utils::flushLog();
     original_buffer = std::cout.rdbuf();
 #ifdef _WIN32
     null_stream.open("NUL");
@@ -17,6 +21,7 @@ class StdoutSuppressor : public ::testing::EmptyTestEventListener {
   }
 
   void OnTestEnd(const ::testing::TestInfo&) override {
+    utils::flushLog();
     std::cout.rdbuf(original_buffer);
     null_stream.close();
   }
@@ -0,0 +1,28 @@
+// save_file_test.cpp
+#include "cartridge/save_file.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+namespace gb {
+
+#ifndef __EMSCRIPTEN__
+TEST(SaveFileTest, OneInstancePerFile) {
+  auto path = (std::filesystem::temp_directory_path() / "gb_save_file_test.sav").string();
+  std::filesystem::remove(path);
+
+  SaveFile first, second;
+  ASSERT_TRUE(first.open(path, 0x2000));
+  first.data()[0] = 0x42;
+  EXPECT_FALSE(second.open(path, 0x2000));
+
+  first.close();
+  ASSERT_TRUE(second.open(path, 0x2000));
+  EXPECT_EQ(second.data()[0], 0x42);
+  second.close();
+  std::filesystem::remove(path);
+}
+#endif
+
+} // namespace gb
@@ -0,0 +1,62 @@
+// save_state_test.cpp
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "machine/gameboy.h"
+#include "test_base.h"
+
+namespace gb {
+
+TEST(SaveStateTest, RestoredMachineRunsIdentically) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoy gb(TEST_ROM, {.audio = false, .battery_save = false});
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+
+  std::vector<u8> state(gb.stateSize());
+  ASSERT_EQ(gb.saveState(state), state.size());
+
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  std::vector<u8> expected(state.size());
+  ASSERT_EQ(gb.saveState(expected), expected.size());
+  ASSERT_NE(state, expected);
+
+  ASSERT_TRUE(gb.loadState(state));
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  std::vector<u8> actual(state.size());
+  ASSERT_EQ(gb.saveState(actual), actual.size());
+  EXPECT_EQ(actual, expected);
+}
+
+TEST(SaveStateTest, RejectsInvalidState) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoy gb(TEST_ROM, {.audio = false, .battery_save = false});
+  std::vector<u8> state(gb.stateSize());
+  ASSERT_EQ(gb.saveState(state), state.size());
+  EXPECT_EQ(gb.saveState({state.data(), state.size() - 1}), 0);
+
+  state[4]++; // version
+  EXPECT_FALSE(gb.loadState(state));
+  state.pop_back();
+  EXPECT_FALSE(gb.loadState(state));
+}
+
+TEST(SaveStateTest, ForkRunsLikeParent) {
+  GB_SKIP_WITHOUT_ROM();
+  GameBoy gb(TEST_ROM, {.audio = false, .battery_save = false});
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  auto child = gb.fork();
+  EXPECT_EQ(child->cartridge_->romImage(), gb.cartridge_->romImage());
+
+  gb.rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  child->rtc_.step(RTC::CYCLES_PER_FRAME * 30);
+  // the periodic tasks of the child run at the cycles of the parent.
+  EXPECT_EQ(child->rtc_.scheduler().clock(), gb.rtc_.scheduler().clock());
+  std::vector<u8> expected(gb.stateSize());
+  std::vector<u8> actual(child->stateSize());
+  ASSERT_EQ(gb.saveState(expected), expected.size());
+  ASSERT_EQ(child->saveState(actual), actual.size());
+  EXPECT_EQ(actual, expected);
+}
+
+} // namespace gb
@@ -0,0 +1,138 @@
+// scheduler_test.cpp
+#include "machine/cpu/scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "machine/cpu/rtc.h"
+
+namespace gb {
+
+class SchedulerTest : public ::testing::Test {
+protected:
+  Scheduler scheduler_;
+  std::string log_;
+};
+
+TEST_F(SchedulerTest, EmptyQueueNeverDue) { EXPECT_EQ(scheduler_.nextDeadline(), Scheduler::NEVER); }
+
+TEST_F(SchedulerTest, PeriodicTaskRunsEveryPeriod) {
+  int count = 0;
+  scheduler_.addPeriodicTask(100, Scheduler::Priority::kNORMAL, [&] { count++; });
+  EXPECT_EQ(scheduler_.nextDeadline(), 100);
+  scheduler_.advance(99);
+  EXPECT_EQ(count, 0);
+  scheduler_.advance(1);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(scheduler_.nextDeadline(), 200);
+  scheduler_.advance(250);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(scheduler_.now(), 350);
+}
+
+TEST_F(SchedulerTest, SameDeadlineRunsByPriority) {
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kLOW, [&] { log_ += 'L'; });
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kHIGH, [&] { log_ += 'H'; });
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] { log_ += 'N'; });
+  scheduler_.advance(10);
+  EXPECT_EQ(log_, "HNL");
+}
+
+TEST_F(SchedulerTest, EarlierDeadlineRunsFirst) {
+  scheduler_.addPeriodicTask(20, Scheduler::Priority::kHIGH, [&] { log_ += 'B'; });
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kLOW, [&] { log_ += 'A'; });
+  scheduler_.advance(20);
+  EXPECT_EQ(log_, "ABA");
+}
+
+TEST_F(SchedulerTest, RemovedTaskDoesNotRun) {
+  int count = 0;
+  auto id   = scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] { count++; });
+  scheduler_.removeTask(id);
+  scheduler_.advance(100);
+  EXPECT_EQ(count, 0);
+  EXPECT_EQ(scheduler_.nextDeadline(), Scheduler::NEVER);
+}
+
+TEST_F(SchedulerTest, TaskCanRemoveItself) {
+  int count = 0;
+  Scheduler::TaskId id{};
+  id = scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] {
+    if (++count == 2) {
+      scheduler_.removeTask(id);
+    }
+  });
+  scheduler_.advance(100);
+  EXPECT_EQ(count, 2);
+}
+
+TEST_F(SchedulerTest, TaskCanAddTask) {
+  int count = 0;
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] {
+    if (log_.empty()) {
+      log_ += 'x';
+      scheduler_.addPeriodicTask(5, Scheduler::Priority::kNORMAL, [&] { count++; });
+    }
+  });
+  scheduler_.advance(30);
+  EXPECT_EQ(count, 4);
+}
+
+TEST_F(SchedulerTest, RebaseKeepsThePhaseOfTheClock) {
+  int count = 0;
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] { count++; });
+  scheduler_.advance(25);
+  EXPECT_EQ(count, 2);
+  // e.g. a state saved at cycle 103, the next run is at 110.
+  scheduler_.rebase(103);
+  EXPECT_EQ(scheduler_.now(), 25);
+  EXPECT_EQ(scheduler_.nextDeadline(), 32);
+  scheduler_.advance(7);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(scheduler_.clock(), 110);
+  // and back to an earlier one.
+  scheduler_.rebase(41);
+  scheduler_.advance(9);
+  EXPECT_EQ(count, 4);
+  EXPECT_EQ(scheduler_.nextDeadline(), scheduler_.now() + 10);
+}
+
+TEST_F(SchedulerTest, TaskCanRebase) {
+  int count = 0;
+  scheduler_.addPeriodicTask(10, Scheduler::Priority::kNORMAL, [&] {
+    if (count++ == 0) {
+      scheduler_.rebase(15);
+    }
+  });
+  scheduler_.advance(10);
+  // queued once, at clock 20.
+  EXPECT_EQ(scheduler_.nextDeadline(), 15);
+  scheduler_.advance(20);
+  EXPECT_EQ(count, 3);
+}
+
+// the UI steps the CPU itself after pause(), no slice may still be running then.
+TEST(RTCTest, PauseWaitsForTheSlice) {
+  RTC rtc;
+  std::atomic<bool> in_slice{};
+  rtc.cpuSpeedLock(true);
+  rtc.cpuTask([&](u64 budget) {
+    in_slice = true;
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    in_slice = false;
+    return budget;
+  });
+  rtc.runWithNewThread();
+  for (int i = 0; i < 20; i++) {
+    rtc.resume();
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    rtc.pause();
+    EXPECT_FALSE(in_slice);
+  }
+  rtc.stop();
+}
+
+} // namespace gb
@@ -1,59 +1,243 @@
 #pragma once
 
-#include <condition_variable>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
 
+#include "common/circle_buffer.h"
+#include "common/pattern_matcher.h"
 #include "machine/gameboy.h"
 #include "machine/serial/serial_buffer.h"
+#include "png.h"
 
 namespace gb {
 
-class Monitor {
+// a short ROM for the tests which need a running machine, the suites are downloaded separately.
+inline constexpr const char *TEST_ROM = "../tests/gb-test-roms/cpu_instrs/individual/01-special.gb";
+
+// skip the calling test if TEST_ROM is not there.
+#define GB_SKIP_WITHOUT_ROM()                         \
+  do {                                                \
+    if (!std::filesystem::exists(::gb::TEST_ROM)) {   \
+      GTEST_SKIP() << ::gb::TEST_ROM << " not found"; \
+    }                                                 \
+  } while (0)
+
+// Checks the serial port: the test passes or fails when the ROM prints one of its markers. the
+// output is matched as it is sent, only its tail is kept for the failure message.
+class Monitor : public SerialSink {
 public:
-  enum CheckStatus {
-    kFAILED = 0,
-    kSUCCESS,
-    kUNKNOWN,
+  static constexpr u32 TAIL_SIZE = 256;
+
+  // the first one printed decides.
+  struct Markers {
+    std::string success;
+    std::string failure;
+
+    bool empty() const { return success.empty() && failure.empty(); }
   };
 
-  using CheckFunction = std::function<CheckStatus(const std::vector<u8> &)>;
+  struct Result {
+    bool success{};
+    bool timeout{}; // no verdict before the deadline
+    f64 seconds{};  // wall time
+    f64 emulated_seconds{};
+    std::string detail; // why it failed, if the checker knows
+  };
 
-  Monitor(GameBoy *gb, const CheckFunction &chk_func) : gb_(gb), check_function(chk_func) {
+  Monitor(GameBoy *gb, const Markers &markers)
+      : gb_(gb),
+        matcher_({markers.success, markers.failure}),
+        tail_(TAIL_SIZE) {
     GB_ASSERT(gb_ != nullptr);
-    GB_ASSERT(check_function != nullptr);
+    GB_ASSERT(!markers.success.empty() && !markers.failure.empty());
   }
 
-  bool run(u64 timeout) {
-    thread_ = std::thread([&]() {
-      std::unique_lock<std::mutex> lk(cv_mutex_);
-      cv_.wait_for(lk, std::chrono::seconds(timeout));
-      gb_->rtc_.stop();
-    });
+  // run headless and unpaced on the calling thread, frame by frame, until a marker is printed or
+  // `timeout` seconds of emulated time have passed.
+  Result run(u64 timeout) {
+    gb_->serial_.sink(this);
 
-    serial_buffer_.serialObserver([&](const auto &v) { check(v); });
-    gb_->serial_.buffer(&serial_buffer_);
-    thread_.detach();
-    gb_->rtc_.run();
-    return success_;
+    auto begin   = std::chrono::steady_clock::now();
+    u64 deadline = timeout * RTC::FREQUENCY;
+    u64 t_cycles = 0;
+    while (!done_ && t_cycles < deadline) {
+      t_cycles += gb_->rtc_.step(RTC::CYCLES_PER_FRAME);
+    }
+    gb_->serial_.sink(nullptr);
+
+    Result result;
+    result.success          = success_;
+    result.timeout          = !done_;
+    result.seconds          = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+    result.emulated_seconds = (f64) t_cycles / RTC::FREQUENCY;
+    if (!success_) {
+      result.detail = "serial output: \"" + tail() + "\"";
+    }
+    return result;
+  }
+
+  void push(u8 data) override {
+    tail_.push(data);
+    u32 marker = matcher_.feed(data);
+    if (!done_ && marker != PatternMatcher::NONE) {
+      success_ = marker == 0;
+      done_    = true;
+    }
   }
 
 private:
-  void check(const std::vector<u8> &v) {
-    CheckStatus status = check_function(v);
-    if (status != kUNKNOWN) {
-      success_ = !!status;
-      cv_.notify_all();
+  // the last bytes printed, the unprintable ones as '.'.
+  std::string tail() const {
+    std::string text;
+    for (u32 i = 0; i < tail_.size(); i++) {
+      text += isprint(tail_[i]) ? (char) tail_[i] : '.';
     }
+    return text;
   }
 
 private:
   GameBoy *gb_{};
-  CheckFunction check_function{};
-  std::thread thread_;
-  SerialBuffer serial_buffer_;
-  std::vector<u8> expect_;
-  std::condition_variable cv_;
-  std::mutex cv_mutex_;
+  PatternMatcher matcher_;
+  CircleBuffer<u8> tail_;
   bool success_{};
+  bool done_{};
+};
+
+// Checks the screen rather than the serial port. Runs until frame `frame`, or when `frame` is 0
+// until the ROM executes LD B,B and the frame being drawn is complete, then compares the shades
+// (0-3) of that frame with a reference PNG, or hashes them when there is none. On a mismatch the
+// actual frame, the reference and the differing pixels are written side by side to DIFF_DIR.
+class ScreenMonitor {
+public:
+  static constexpr const char *DIFF_DIR = "gb_test_diff";
+
+  struct Reference {
+    std::string png; // 4 shades of gray, white is shade 0
+    u64 hash{};      // fnv1a of the shades, used without a png
+    u64 frame{};     // 0: the frame after LD B,B
+  };
+
+  ScreenMonitor(GameBoy *gb, const std::string &name, const Reference &reference)
+      : gb_(gb),
+        name_(name),
+        reference_(reference) {
+    GB_ASSERT(gb_ != nullptr);
+  }
+
+  Monitor::Result run(u64 timeout) {
+    static constexpr u64 LINE_CYCLES = 456;
+
+    auto &ppu = gb_->ppu_;
+    std::vector<u8> shades(LCD_WIDTH * LCD_HEIGHT);
+    ppu.shadeBuffer(shades.data());
+    gb_->cpu_.breakpoint(false);
+
+    auto reached = [&] {
+      return reference_.frame ? ppu.frameCount() >= reference_.frame : gb_->cpu_.breakpoint();
+    };
+    auto begin   = std::chrono::steady_clock::now();
+    u64 deadline = timeout * RTC::FREQUENCY;
+    u64 t_cycles = 0;
+    while (!reached() && t_cycles < deadline) {
+      t_cycles += gb_->rtc_.step(LINE_CYCLES);
+    }
+
+    Monitor::Result result;
+    result.timeout = !reached();
+    if (!result.timeout && !reference_.frame) {
+      // stop in the vertical blank, unless the LCD is off.
+      u64 frame = ppu.frameCount();
+      u64 end   = t_cycles + RTC::CYCLES_PER_FRAME;
+      while (ppu.frameCount() == frame && t_cycles < end) {
+        t_cycles += gb_->rtc_.step(LINE_CYCLES);
+      }
+    }
+    ppu.shadeBuffer(nullptr);
+
+    if (!result.timeout) {
+      result.success = compare(shades, result.detail);
+    }
+    result.seconds          = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+    result.emulated_seconds = (f64) t_cycles / RTC::FREQUENCY;
+    return result;
+  }
+
+private:
+  bool compare(const std::vector<u8> &shades, std::string &detail) const {
+    char buf[256];
+    u64 hash = fnv1a(shades.data(), shades.size());
+    if (reference_.png.empty()) {
+      if (hash == reference_.hash) {
+        return true;
+      }
+      snprintf(buf, sizeof(buf), "frame hash %016" PRIx64 ", expected %016" PRIx64 ", see %s", hash,
+               reference_.hash, writeDiff(shades, nullptr).c_str());
+      detail = buf;
+      return false;
+    }
+
+    Image image;
+    if (!readPng(reference_.png, image) || image.width != LCD_WIDTH || image.height != LCD_HEIGHT) {
+      detail = "can not read the reference " + reference_.png;
+      return false;
+    }
+    std::vector<u8> expected(shades.size());
+    u32 differ = 0;
+    for (u32 i = 0; i < expected.size(); i++) {
+      const u8 *rgb = &image.rgb[i * 3];
+      u32 luma      = (rgb[0] * 299 + rgb[1] * 587 + rgb[2] * 114) / 1000;
+      expected[i]   = std::min<u32>((255 - luma + 42) / 85, 3);
+      differ += expected[i] != shades[i];
+    }
+    if (differ == 0) {
+      return true;
+    }
+    snprintf(buf, sizeof(buf), "%u pixels differ, frame hash %016" PRIx64 ", see %s", differ, hash,
+             writeDiff(shades, &expected).c_str());
+    detail = buf;
+    return false;
+  }
+
+  // actual | reference | differing pixels in red over the dimmed actual frame.
+  std::string writeDiff(const std::vector<u8> &shades, const std::vector<u8> *expected) const {
+    auto gray = [](u8 shade) -> u8 { return 255 - shade * 85; };
+
+    Image image;
+    u32 panels   = expected ? 3 : 1;
+    image.width  = LCD_WIDTH * panels;
+    image.height = LCD_HEIGHT;
+    image.rgb.resize(image.width * image.height * 3);
+    for (u32 y = 0; y < LCD_HEIGHT; y++) {
+      for (u32 x = 0; x < LCD_WIDTH; x++) {
+        u32 i  = y * LCD_WIDTH + x;
+        u8 *px = &image.rgb[(y * image.width + x) * 3];
+        memset(px, gray(shades[i]), 3);
+        if (!expected) {
+          continue;
+        }
+        memset(px + LCD_WIDTH * 3, gray((*expected)[i]), 3);
+        u8 *diff = px + LCD_WIDTH * 6;
+        if (shades[i] != (*expected)[i]) {
+          diff[0] = 0xff;
+          diff[1] = diff[2] = 0;
+        } else {
+          memset(diff, 192 + gray(shades[i]) / 4, 3);
+        }
+      }
+    }
+    std::filesystem::create_directories(DIFF_DIR);
+    std::string path = std::string(DIFF_DIR) + "/" + name_ + ".png";
+    return writePng(path, image) ? path : "nothing, can not write " + path;
+  }
+
+  GameBoy *gb_{};
+  std::string name_;
+  Reference reference_;
 };
 
 } // namespace gb
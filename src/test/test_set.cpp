@@ -1,20 +1,27 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "common/thread_pool.h"
 #include "test_base.h"
 
 using namespace gb;
 
 namespace fs          = std::filesystem;
-constexpr u64 TIMEOUT = 5; // seconds
+constexpr u64 TIMEOUT = 5; // seconds of emulated time
 
 struct TestParams {
   std::string path;
-  Monitor::CheckFunction result_checker;
+  Monitor::Markers serial; // none: check the screen against `screen`
   u64 timeout{TIMEOUT};
+  ScreenMonitor::Reference screen;
 
   bool operator<(const TestParams &rhs) const { return path < rhs.path; }
 
@@ -40,8 +47,121 @@ public:
   }
 };
 
-static std::vector<TestParams> getFileList(const std::string &path,
-                                           const Monitor::CheckFunction &result_checker, bool recursive,
+// every instantiated ROM by path, the printed parameter of its test.
+static std::unordered_map<std::string, TestParams> &registry() {
+  static std::unordered_map<std::string, TestParams> registry;
+  return registry;
+}
+
+static Monitor::Result runRom(const TestParams &param) {
+  GameBoy gb(param.path, {.audio = false, .battery_save = false, .rewind_budget = 0});
+  if (param.serial.empty()) {
+    ScreenMonitor monitor(&gb, fs::path(param.path).stem(), param.screen);
+    return monitor.run(param.timeout);
+  }
+  Monitor monitor(&gb, param.serial);
+  return monitor.run(param.timeout);
+}
+
+// Runs every selected ROM up front on a thread pool, one GameBoy per job, and leaves the
+// verdicts for the tests to pick up. GB_TEST_JOBS sets the number of workers.
+class ParallelRomRunner : public ::testing::Environment {
+public:
+  void SetUp() override {
+    std::vector<const TestParams *> roms;
+    auto *unit_test = ::testing::UnitTest::GetInstance();
+    for (int i = 0; i < unit_test->total_test_suite_count(); i++) {
+      const auto *suite = unit_test->GetTestSuite(i);
+      for (int j = 0; j < suite->total_test_count(); j++) {
+        const auto *info = suite->GetTestInfo(j);
+        if (!info->should_run() || info->value_param() == nullptr) {
+          continue;
+        }
+        auto it = registry().find(info->value_param());
+        if (it != registry().end()) {
+          roms.push_back(&it->second);
+        }
+      }
+    }
+    if (roms.empty()) {
+      return;
+    }
+
+    u32 threads = std::thread::hardware_concurrency();
+    if (const char *jobs = std::getenv("GB_TEST_JOBS")) {
+      threads = std::strtoul(jobs, nullptr, 10);
+    }
+
+    // the emulator logs to stdout, keep it quiet while the workers run.
+    std::ofstream null_stream("/dev/null");
+    utils::flushLog();
+    auto *original_buffer = std::cout.rdbuf(null_stream.rdbuf());
+    auto begin            = std::chrono::steady_clock::now();
+    {
+      ThreadPool pool(threads);
+      for (const auto *rom: roms) {
+        pool.submit([this, rom] {
+          auto result = runRom(*rom);
+          std::lock_guard lock(mutex_);
+          results_[rom->path] = result;
+        });
+      }
+      pool.wait();
+      threads_ = pool.size();
+    }
+    seconds_ = std::chrono::duration<f64>(std::chrono::steady_clock::now() - begin).count();
+    utils::flushLog();
+    std::cout.rdbuf(original_buffer);
+  }
+
+  void TearDown() override {
+    if (results_.empty()) {
+      return;
+    }
+    u32 passed = 0, failed = 0, timeout = 0;
+    f64 seconds = 0;
+    std::vector<std::pair<f64, std::string>> slowest;
+    for (const auto &[path, result]: results_) {
+      passed += result.success;
+      timeout += result.timeout;
+      failed += !result.success && !result.timeout;
+      seconds += result.seconds;
+      slowest.emplace_back(result.seconds, path);
+    }
+    std::sort(slowest.rbegin(), slowest.rend());
+    slowest.resize(std::min<size_t>(slowest.size(), 5));
+
+    printf("[ROMS     ] %zu ROMs: %u passed, %u failed, %u timed out\n", results_.size(), passed, failed,
+           timeout);
+    printf("[ROMS     ] %.2f s on %u threads, %.2f s of work\n", seconds_, threads_, seconds);
+    for (const auto &[s, path]: slowest) {
+      printf("[ROMS     ]   %7.3f s  %s\n", s, path.c_str());
+    }
+  }
+
+  // the cached verdict, false if the ROM was not run up front.
+  static bool result(const std::string &path, Monitor::Result &result) {
+    std::lock_guard lock(mutex_);
+    auto it = results_.find(path);
+    if (it == results_.end()) {
+      return false;
+    }
+    result = it->second;
+    return true;
+  }
+
+private:
+  static inline std::mutex mutex_;
+  static inline std::unordered_map<std::string, Monitor::Result> results_;
+  u32 threads_{};
+  f64 seconds_{};
+};
+
+[[maybe_unused]] static auto *parallel_rom_runner =
+    ::testing::AddGlobalTestEnvironment(new ParallelRomRunner);
+
+static std::vector<TestParams> getFileList(const std::string &path, const Monitor::Markers &serial,
+                                           bool recursive,
                                            std::unordered_set<std::string> ignore_files,
                                            u64 timeout = TIMEOUT) {
   std::vector<TestParams> v;
@@ -50,7 +170,7 @@ static std::vector<TestParams> getFileList(const std::string &path,
       if (ignore_files.contains(entry.path().filename())) {
         return;
       }
-      v.push_back({entry.path(), result_checker, timeout});
+      v.push_back({entry.path(), serial, timeout, {}});
     }
   };
   if (!recursive) {
@@ -63,107 +183,122 @@ static std::vector<TestParams> getFileList(const std::string &path,
     }
   }
   std::sort(v.begin(), v.end());
+  for (const auto &param: v) {
+    registry()[param.path] = param;
+  }
   return v;
 }
 
-static Monitor::CheckStatus gb_test_roms_checker(const std::vector<u8> &v) {
-  if (v.size() < 4) {
-    return Monitor::kUNKNOWN;
-  }
-  std::string str{v.begin(), v.end()};
-  if (str.find("Pass") != std::string::npos) {
-    return Monitor::kSUCCESS;
-  } else if (str.find("Failed") != std::string::npos) {
-    return Monitor::kFAILED;
-  } else {
-    return Monitor::kUNKNOWN;
+// ROMs under `path` which have a reference screenshot of the same name in `expected_path`.
+// missing directories yield no tests, the suites are downloaded separately.
+static std::vector<TestParams> getScreenshotList(const std::string &path, const std::string &expected_path,
+                                                 u64 timeout = TIMEOUT) {
+  std::vector<TestParams> v;
+  if (!fs::is_directory(path) || !fs::is_directory(expected_path)) {
+    return v;
   }
-}
-
-static Monitor::CheckStatus mts_checker(const std::vector<u8> &v) {
-  const std::string success{3, 5, 8, 13, 21, 34};
-  const std::string fail{'B', 'B', 'B', 'B', 'B', 'B'};
-  if (v.size() < success.size()) {
-    return Monitor::kUNKNOWN;
+  for (const auto &entry: fs::recursive_directory_iterator(path)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".gb") {
+      continue;
+    }
+    auto png = fs::path(expected_path) / entry.path().filename().replace_extension(".png");
+    if (fs::exists(png)) {
+      v.push_back({entry.path(), {}, timeout, {.png = png}});
+    }
   }
-  std::string str{v.begin(), v.end()};
-  if (str.find(success) != std::string::npos) {
-    return Monitor::kSUCCESS;
-  } else if (str.find(fail) != std::string::npos) {
-    return Monitor::kFAILED;
-  } else {
-    return Monitor::kUNKNOWN;
+  std::sort(v.begin(), v.end());
+  for (const auto &param: v) {
+    registry()[param.path] = param;
   }
+  return v;
 }
 
+static const Monitor::Markers gb_test_roms_markers{"Pass", "Failed"};
+
+// the Fibonacci numbers in B, C, D, E, H and L, or 0x42 in each on failure.
+static const Monitor::Markers mts_markers{{3, 5, 8, 13, 21, 34}, "BBBBBB"};
+
 TEST_P(GBTest, ARGS) {
-  TestParams param = GetParam();
-  GameBoy gb(param.path);
-  Monitor monitor(&gb, param.result_checker);
-  EXPECT_TRUE(monitor.run(param.timeout));
+  const TestParams &param = GetParam();
+  Monitor::Result result;
+  if (!ParallelRomRunner::result(param.path, result)) {
+    result = runRom(param);
+  }
+  EXPECT_TRUE(result.success) << (result.timeout ? "no verdict after " : "failed after ")
+                              << result.emulated_seconds << " s of emulated time. " << result.detail;
 }
 
 INSTANTIATE_TEST_SUITE_P(gb_test_roms_cpu_instrs, GBTest,
                          ::testing::ValuesIn(getFileList("../tests/gb-test-roms/cpu_instrs/",
-                                                         gb_test_roms_checker, true, {}, 120)),
+                                                         gb_test_roms_markers, true, {}, 120)),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(gb_test_roms_instr_timing, GBTest,
                          ::testing::ValuesIn(getFileList("../tests/gb-test-roms/instr_timing",
-                                                         gb_test_roms_checker, true, {})),
+                                                         gb_test_roms_markers, true, {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(gb_test_roms_interrupt_time, GBTest,
                          ::testing::ValuesIn(getFileList("../tests/gb-test-roms/interrupt_time",
-                                                         gb_test_roms_checker, false, {})),
+                                                         gb_test_roms_markers, false, {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(gb_test_roms_mem_timing, GBTest,
                          ::testing::ValuesIn(getFileList("../tests/gb-test-roms/mem_timing",
-                                                         gb_test_roms_checker, true, {}, 20)),
+                                                         gb_test_roms_markers, true, {}, 20)),
                          GBTest::ParamToString);
 
 
 INSTANTIATE_TEST_SUITE_P(gb_test_roms_mem_timing2, GBTest,
                          ::testing::ValuesIn(getFileList("../tests/gb-test-roms/mem_timing-2",
-                                                         gb_test_roms_checker, true, {}, 20)),
+                                                         gb_test_roms_markers, true, {}, 20)),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_emulator_only_mbc1, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/emulator-only/mbc1/", mts_checker,
+                         ::testing::ValuesIn(getFileList("../tests/mts/emulator-only/mbc1/", mts_markers,
                                                          false, {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_bits, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/bits", mts_checker, false,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/bits", mts_markers, false,
                                                          {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_instr, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/instr", mts_checker, false,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/instr", mts_markers, false,
                                                          {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_interrupts, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/interrupts", mts_checker,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/interrupts", mts_markers,
                                                          false, {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_ppu, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/ppu", mts_checker, false,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/ppu", mts_markers, false,
                                                          {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_timer, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/timer", mts_checker, false,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/timer", mts_markers, false,
                                                          {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_root, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/", mts_checker, false, {})),
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/", mts_markers, false, {})),
                          GBTest::ParamToString);
 
 INSTANTIATE_TEST_SUITE_P(mts_acceptance_oam_dma, GBTest,
-                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/oam_dma", mts_checker, true,
+                         ::testing::ValuesIn(getFileList("../tests/mts/acceptance/oam_dma", mts_markers, true,
                                                          {"sources-GS.gb"})),
-                         GBTest::ParamToString);
\ No newline at end of file
+                         GBTest::ParamToString);
+
+INSTANTIATE_TEST_SUITE_P(mealybug_tearoom, GBTest,
+                         ::testing::ValuesIn(getScreenshotList(
+                                 "../tests/mealybug-tearoom-tests/build",
+                                 "../tests/mealybug-tearoom-tests/expected/DMG-blob")),
+                         GBTest::ParamToString);
+
+INSTANTIATE_TEST_SUITE_P(dmg_acid2, GBTest,
+                         ::testing::ValuesIn(getScreenshotList("../tests/dmg-acid2", "../tests/dmg-acid2")),
+                         GBTest::ParamToString);
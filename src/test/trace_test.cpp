@@ -0,0 +1,52 @@
+// trace_test.cpp
+#include "common/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace gb {
+
+static u32 count(const std::string &text, const std::string &pattern) {
+  u32 n = 0;
+  for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+    n++;
+  }
+  return n;
+}
+
+TEST(TraceTest, ChromeJsonPairsSpans) {
+  struct Clock : ClockSource {
+    u64 cycles() const override { return now; }
+    u64 now{};
+  } clock;
+
+  Trace::clearAll();
+  auto &trace = Trace::local();
+  {
+    TraceClockScope scope(&clock);
+    trace.record(TraceTrack::kDMA, 'E', nullptr); // its begin was overwritten
+    clock.now = 100;
+    trace.record(TraceTrack::kPPU_MODE, 'B', "oam scan", 0); // still open
+    clock.now = 180;
+    trace.record(TraceTrack::kIRQ_RAISED, 'i', "vblank", 0);
+    trace.record(TraceTrack::kHOST, 'B', "emulate");
+    trace.record(TraceTrack::kHOST, 'E', nullptr);
+  }
+  EXPECT_EQ(trace.clock(), nullptr);
+
+  auto json = Trace::chromeJson();
+  EXPECT_EQ(json.rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n", 0), 0);
+  EXPECT_EQ(json.substr(json.size() - 5), "}\n]}\n");
+  EXPECT_NE(json.find("\"name\": \"gameboy 1\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"oam scan\", \"cat\": \"ppu mode\", \"ph\": \"B\""), std::string::npos);
+  EXPECT_NE(json.find("\"cycle\": 100, \"ly\": 0"), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"vblank\", \"cat\": \"irq raised\", \"ph\": \"i\", \"s\": \"t\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"emulate\", \"cat\": \"host\", \"ph\": \"B\""), std::string::npos);
+  // the host span and the mode closed at the last event, the orphan DMA end dropped.
+  EXPECT_EQ(count(json, "\"ph\": \"E\""), 2);
+  Trace::clearAll();
+}
+
+} // namespace gb
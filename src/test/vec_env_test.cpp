@@ -0,0 +1,74 @@
+// vec_env_test.cpp
+#include "machine/vec_env.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "test_base.h"
+
+namespace gb {
+
+TEST(VecEnvTest, LockstepInstancesStayIdentical) {
+  GB_SKIP_WITHOUT_ROM();
+  VecEnv env(TEST_ROM, 4, 2);
+  ASSERT_EQ(env.size(), 4);
+  ASSERT_EQ(env.observations().size(), 4 * VecEnv::OBSERVATION_SIZE);
+
+  std::vector<u8> actions(env.size(), 0);
+  for (u32 frame = 0; frame < 30; frame++) {
+    actions.assign(env.size(), frame % 2 ? Joypad::kA : 0);
+    env.step(actions);
+  }
+
+  for (u32 i = 0; i < env.size(); i++) {
+    EXPECT_EQ(env.registers().pc[i], env.env(i).cpu_.PC());
+    EXPECT_EQ(env.registers().af[i], env.env(i).cpu_.AF());
+    EXPECT_EQ(env.registers().sp[i], env.registers().sp[0]);
+    auto observation = env.observation(i);
+    EXPECT_TRUE(std::equal(observation.begin(), observation.end(), env.observation(0).begin()));
+  }
+
+  // back to a fresh instance, observations and registers included.
+  env.reset();
+  VecEnv fresh(TEST_ROM, 1, 1);
+  auto blank = fresh.observation(0);
+  for (u32 i = 0; i < env.size(); i++) {
+    EXPECT_EQ(env.registers().pc[i], fresh.env(0).cpu_.PC());
+    EXPECT_EQ(env.registers().sp[i], fresh.env(0).cpu_.SP());
+    auto observation = env.observation(i);
+    EXPECT_TRUE(std::equal(observation.begin(), observation.end(), blank.begin()));
+  }
+  env.step(actions);
+  fresh.step(std::vector<u8>{actions[0]});
+  for (u32 i = 0; i < env.size(); i++) {
+    auto observation = env.observation(i);
+    EXPECT_TRUE(std::equal(observation.begin(), observation.end(), fresh.observation(0).begin()));
+  }
+}
+
+TEST(VecEnvTest, ObservationMatchesDisplayedFrame) {
+  GB_SKIP_WITHOUT_ROM();
+  VecEnv env(TEST_ROM, 1, 1);
+  std::vector<u8> actions{0};
+  for (u32 frame = 0; frame < 60; frame++) {
+    env.step(actions);
+  }
+  ASSERT_EQ(env.env(0).ppu_.lcdData().get()[3], 0xff);
+
+  // the step stops in the vertical blank, right after the buffers switched.
+  const u8 *rgba   = env.env(0).ppu_.lcdData().get();
+  auto observation = env.observation(0);
+  std::vector<u32> shade_color(4, 0);
+  for (u32 i = 0; i < VecEnv::OBSERVATION_SIZE; i++) {
+    u8 shade = observation[i];
+    ASSERT_LT(shade, 4);
+    u32 color = rgba[i * 4] << 16 | rgba[i * 4 + 1] << 8 | rgba[i * 4 + 2];
+    if (!shade_color[shade]) {
+      shade_color[shade] = color | 1u << 24;
+    }
+    EXPECT_EQ(shade_color[shade], color | 1u << 24) << "pixel " << i;
+  }
+}
+
+} // namespace gb
@@ -4,6 +4,8 @@
 #include <imgui.h>
 
 #include "colors.h"
+#include "common/profiler.h"
+#include "common/trace.h"
 #include "imgui.h"
 
 namespace gb {
@@ -104,6 +106,7 @@ static bool updateGameboyLCD(GameBoy* gb, GLuint* out_texture, int* out_width, i
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+  GB_TRACE_SCOPE("texture upload");
   const gb::u8* original_data = gb->ppu_.lcdData().get();
   std::vector<gb::u8> scaled_data(SCALED_WIDTH * SCALED_HEIGHT * 4);
 
@@ -138,6 +141,20 @@ void Widgets::drawControlWindow() {
   ImGui::Checkbox("Disassembler", &show_disassembler_);
   ImGui::Checkbox("Memory Editor", &show_memory_editor_);
   ImGui::Checkbox("Game", &show_game_);
+  ImGui::Checkbox("Profiler", &show_profiler_);
+
+  f32 speed = gameboy_->rtc_.speed();
+  ImGui::SetNextItemWidth(120);
+  if (ImGui::SliderFloat("Speed", &speed, gb::RTC::MIN_SPEED, gb::RTC::MAX_SPEED, "%.2fx",
+                         ImGuiSliderFlags_Logarithmic)) {
+    gameboy_->rtc_.speed(speed);
+  }
+
+  const auto& rewind = gameboy_->rewindBuffer();
+  ImGui::Text("Rewind: %u snapshots, %.1f / %.0f MB", rewind.size(), rewind.bytes() / 1048576.0,
+              rewind.budget() / 1048576.0);
+  static constexpr const char* MOVIE_MODES[] = {"off", "recording", "playing"};
+  ImGui::Text("Movie: %s (F5 record, F6 play)", MOVIE_MODES[(int) gameboy_->movieMode()]);
 
   ImGui::End();
 }
@@ -344,11 +361,21 @@ void Widgets::drawCPURegisters() {
 }
 
 void Widgets::drawDisassembler() {
+  auto& disassembler = gameboy_->cpu_.disassembler();
   if (!show_disassembler_) {
-    gameboy_->cpu_.disassembler().disable();
+    disassembler.disable();
+    disassembler_requested_ = false;
     return;
   }
-  gameboy_->cpu_.disassembler().enable();
+  // the first enable decodes the ROM through the mapper, not while the emulation thread runs.
+  if (!disassembler.enabled() && !disassembler_requested_) {
+    disassembler_requested_ = true;
+    if (gameboy_->rtc_.paused()) {
+      disassembler.enable();
+    } else {
+      gameboy_->post([gameboy = gameboy_] { gameboy->cpu_.disassembler().enable(); });
+    }
+  }
 
   ImGui::SetNextWindowPos(ImVec2(462, 0), ImGuiCond_Once);
   ImGui::SetNextWindowSize(ImVec2(315, 400), ImGuiCond_Once);
@@ -369,16 +396,21 @@ void Widgets::drawDisassembler() {
   }
   ImGui::SameLine();
   if (ImGui::Button("Step")) {
+    // pause() returns between two slices, the emulation thread no longer touches the machine.
     gameboy_->rtc_.pause();
-    if (gameboy_->rtc_.paused()) {
-      gameboy_->cpu_.update();
-    }
+    // one instruction
+    gameboy_->rtc_.step(1);
   }
 
 
+  if (!disassembler.ready()) {
+    ImGui::Text("decoding the ROM...");
+    ImGui::End();
+    return;
+  }
+
   ImGui::BeginChild("ASM", ImVec2(0, 300), ImGuiChildFlags_Border, 0);
-  const auto& disassembler = gameboy_->cpu_.disassembler();
-  u16 pc                   = gameboy_->cpu_.PC();
+  u16 pc = gameboy_->cpu_.PC();
   ImGuiListClipper clipper;
 
   u16 record_count = disassembler.recordCount();
@@ -504,7 +536,7 @@ void Widgets::drawFrameRate() {
   cpu_speed_buffer_.push((f32) gameboy_->rtc_.cpuSpeed());
 
   ImGui::SetNextWindowPos(ImVec2(143, 0), ImGuiCond_Once);
-  ImGui::SetNextWindowSize(ImVec2(316, 169), ImGuiCond_Once);
+  ImGui::SetNextWindowSize(ImVec2(316, 245), ImGuiCond_Once);
   ImGui::Begin("Frame Rate", &show_frame_rate_, ImGuiWindowFlags_NoResize);
 
 
@@ -518,6 +550,96 @@ void Widgets::drawFrameRate() {
   ImGui::PlotLines("", circle_buffer_getter, &cpu_speed_buffer_, cpu_speed_buffer_.size(), 0, buf, 1000000.f,
                    40000000.f, ImVec2(300, 65));
 
+  auto pacer = gameboy_->rtc_.pacerStats();
+  f32 frame_time_histogram[FramePacer::HISTOGRAM_BUCKETS];
+  std::copy(std::begin(pacer.histogram), std::end(pacer.histogram), frame_time_histogram);
+  sprintf(buf, "Frame Time: %.2f ms, late: %lu", pacer.last_frame_ns / 1e6, pacer.late_frames);
+  ImGui::PlotHistogram("", frame_time_histogram, FramePacer::HISTOGRAM_BUCKETS, 0, buf, 0.f, FLT_MAX,
+                       ImVec2(300, 65));
+
+  ImGui::End();
+}
+
+// folded stacks for flamegraph.pl, in the working directory.
+static constexpr const char* GUEST_PROFILE_PATH = "gb_guest.folded";
+// for chrome://tracing and ui.perfetto.dev.
+[[maybe_unused]] static constexpr const char* TRACE_PATH = "gb_trace.json";
+
+void Widgets::drawProfiler() {
+  if (!show_profiler_) {
+    return;
+  }
+
+  ImGui::SetNextWindowSize(ImVec2(460, 420), ImGuiCond_Once);
+  ImGui::Begin("Profiler", &show_profiler_);
+#ifndef GB_PROFILE
+  ImGui::TextWrapped("Counted only in builds with GB_PROFILE, cmake -DGB_PROFILE=ON.");
+#else
+  if (ImGui::Button("Reset")) {
+    Profile::resetAll();
+  }
+  f64 ms_per_tick = 1000 / Profile::ticksPerSecond();
+  for (const auto& snapshot : Profile::collect()) {
+    char title[32];
+    sprintf(title, "Thread %u", snapshot.thread);
+    if (!ImGui::CollapsingHeader(title, ImGuiTreeNodeFlags_DefaultOpen)) {
+      continue;
+    }
+    ImGui::PushID(snapshot.thread);
+    if (ImGui::BeginTable("zones", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+      ImGui::TableSetupColumn("Zone");
+      ImGui::TableSetupColumn("Calls");
+      ImGui::TableSetupColumn("Total ms");
+      ImGui::TableSetupColumn("Self ms");
+      ImGui::TableSetupColumn("ns/call");
+      ImGui::TableHeadersRow();
+      for (u8 zone = 0; zone < Profile::ZONES; zone++) {
+        const auto& stats = snapshot.zones[zone];
+        if (stats.calls == 0) {
+          continue;
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(profileZoneName(static_cast<ProfileZone>(zone)));
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", stats.calls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stats.ticks * ms_per_tick);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stats.self_ticks * ms_per_tick);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stats.ticks * ms_per_tick * 1e6 / stats.calls);
+      }
+      ImGui::EndTable();
+    }
+    ImGui::PopID();
+  }
+#endif
+
+#ifdef GB_TRACE
+  ImGui::Separator();
+  if (ImGui::Button("Save trace")) {
+    Trace::writeChromeJson(TRACE_PATH);
+  }
+  ImGui::SameLine();
+  ImGui::Text("last events of every thread to %s", TRACE_PATH);
+#endif
+
+  // the guest profiler is owned by the emulation thread, it is driven through posted tasks.
+  ImGui::Separator();
+  ImGui::Text("Guest code, call stacks written to %s", GUEST_PROFILE_PATH);
+  if (!guest_profiling_ && ImGui::Button("Start")) {
+    guest_profiling_ = true;
+    gameboy_->post([gameboy = gameboy_] { gameboy->cpu_.guestProfiler().enable(); });
+  } else if (guest_profiling_ && ImGui::Button("Stop")) {
+    guest_profiling_ = false;
+    gameboy_->post([gameboy = gameboy_] {
+      auto& profiler = gameboy->cpu_.guestProfiler();
+      profiler.disable();
+      profiler.writeFoldedStacks(GUEST_PROFILE_PATH);
+      GB_LOG(INFO) << profiler.report(20);
+    });
+  }
   ImGui::End();
 }
 
@@ -529,6 +651,7 @@ void Widgets::draw() {
   drawDisassembler();
   drawMemoryViewer();
   drawFrameRate();
+  drawProfiler();
 }
 
 } // namespace gb
@@ -23,6 +23,7 @@ private:
   bool show_game_{true};
   bool show_cpu_registers_{};
   bool show_disassembler_{};
+  bool disassembler_requested_{}; // the first enable is posted to the emulation thread
   void drawControlWindow();
 
   int scale_ = 3;
@@ -56,6 +57,10 @@ private:
   bool show_frame_rate_{true};
   void drawFrameRate();
 
+  bool show_profiler_{};
+  bool guest_profiling_{};
+  void drawProfiler();
+
 private:
   GameBoy* gameboy_{};
 };
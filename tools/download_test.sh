@@ -6,5 +6,11 @@ curl -L https://gekkio.fi/files/mooneye-test-suite/mts-20240127-1204-74ae166/mts
 unzip mts.zip -d .
 mv mts-20240127-1204-74ae166 mts
 
-curl -L https://github.com/mattcurrie/mealybug-tearoom-tests/raw/master/mealybug-tearoom-tests.zip -o mealybug-tearoom-tests.zip
-unzip mealybug-tearoom-tests.zip -d ./mealybug-tearoom-tests
+# the repository holds the reference screenshots (expected/), the zip the built ROMs.
+git clone https://github.com/mattcurrie/mealybug-tearoom-tests.git --depth 1
+unzip mealybug-tearoom-tests/mealybug-tearoom-tests.zip -d ./mealybug-tearoom-tests/build
+
+# the reference screenshot is named after the ROM, as gb_test expects.
+mkdir -p dmg-acid2
+curl -L https://github.com/mattcurrie/dmg-acid2/releases/download/v1.0/dmg-acid2.gb -o dmg-acid2/dmg-acid2.gb
+curl -L https://raw.githubusercontent.com/mattcurrie/dmg-acid2/master/img/reference-dmg.png -o dmg-acid2/dmg-acid2.png